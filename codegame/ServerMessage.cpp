@@ -34,6 +34,12 @@ namespace codegame {
         return GetOrder(playerView, debugAvailable);
     }
 
+    // Read GetOrder from input stream over an existing one, reusing its buffers
+    void GetOrder::readFrom(InputStream& stream, GetOrder& value) {
+        model::Game::readFrom(stream, value.playerView);
+        value.debugAvailable = stream.readBool();
+    }
+
     // Write GetOrder to output stream
     void GetOrder::writeTo(OutputStream& stream) const {
         playerView.writeTo(stream);
@@ -119,6 +125,30 @@ namespace codegame {
         }
     }
 
+    // Read ServerMessage from input stream into message
+    void readServerMessage(InputStream& stream, ServerMessage& message) {
+        switch (stream.readInt()) {
+        case 0:
+            message = UpdateConstants::readFrom(stream);
+            break;
+        case 1:
+            if (GetOrder* getOrder = std::get_if<GetOrder>(&message)) {
+                GetOrder::readFrom(stream, *getOrder);
+            } else {
+                message = GetOrder::readFrom(stream);
+            }
+            break;
+        case 2:
+            message = Finish::readFrom(stream);
+            break;
+        case 3:
+            message = DebugUpdate::readFrom(stream);
+            break;
+        default:
+            throw std::runtime_error("Unexpected tag value");
+        }
+    }
+
     // Write ServerMessage to output stream
     void writeServerMessage(const ServerMessage& value, OutputStream& stream) {
         std::visit([&](auto& arg) {
@@ -57,6 +57,9 @@ namespace codegame {
         // Read GetOrder from input stream
         static GetOrder readFrom(InputStream& stream);
 
+        // Read GetOrder from input stream over an existing one, reusing its buffers
+        static void readFrom(InputStream& stream, GetOrder& value);
+
         // Write GetOrder to output stream
         void writeTo(OutputStream& stream) const;
 
@@ -108,6 +111,10 @@ namespace codegame {
     // Read ServerMessage from input stream
     ServerMessage readServerMessage(InputStream& stream);
 
+    // Read ServerMessage from input stream into message. When both the old and the new
+    // message are GetOrder, the new one is decoded in place without heap allocations.
+    void readServerMessage(InputStream& stream, ServerMessage& message);
+
     // Write ServerMessage to output stream
     void writeServerMessage(const ServerMessage& value, OutputStream& stream);
 
@@ -17,8 +17,14 @@ namespace debugging {
 
     // Write PlacedText to output stream
     void PlacedText::writeTo(OutputStream& stream) const {
+        writeTo(stream, position, text, alignment, size, color);
+    }
+
+    // Write PlacedText fields to output stream without building the object
+    void PlacedText::writeTo(OutputStream& stream, model::Vec2 position, std::string_view text, model::Vec2 alignment, double size, const debugging::Color& color) {
         position.writeTo(stream);
-        stream.write(text);
+        stream.write((int)(text.size()));
+        stream.writeBytes(text.data(), text.size());
         alignment.writeTo(stream);
         stream.write(size);
         color.writeTo(stream);
@@ -296,6 +302,11 @@ namespace debugging {
 
     // Write Polygon to output stream
     void Polygon::writeTo(OutputStream& stream) const {
+        writeTo(stream, vertices, color);
+    }
+
+    // Write Polygon fields to output stream without building the object
+    void Polygon::writeTo(OutputStream& stream, model::Span<const model::Vec2> vertices, const debugging::Color& color) {
         stream.write((int)(vertices.size()));
         for (const model::Vec2& verticesElement : vertices) {
             verticesElement.writeTo(stream);
@@ -463,6 +474,11 @@ namespace debugging {
 
     // Write PolyLine to output stream
     void PolyLine::writeTo(OutputStream& stream) const {
+        writeTo(stream, vertices, width, color);
+    }
+
+    // Write PolyLine fields to output stream without building the object
+    void PolyLine::writeTo(OutputStream& stream, model::Span<const model::Vec2> vertices, double width, const debugging::Color& color) {
         stream.write((int)(vertices.size()));
         for (const model::Vec2& verticesElement : vertices) {
             verticesElement.writeTo(stream);
@@ -5,10 +5,12 @@
 #include "debugging/Color.hpp"
 #include "debugging/ColoredVertex.hpp"
 #include "model/Vec2.hpp"
+#include "model/Span.hpp"
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -35,6 +37,9 @@ namespace debugging {
         // Write PlacedText to output stream
         void writeTo(OutputStream& stream) const;
 
+        // Write PlacedText fields to output stream without building the object
+        static void writeTo(OutputStream& stream, model::Vec2 position, std::string_view text, model::Vec2 alignment, double size, const debugging::Color& color);
+
         // Get string representation of PlacedText
         std::string toString() const;
     };
@@ -201,6 +206,9 @@ namespace debugging {
         // Write Polygon to output stream
         void writeTo(OutputStream& stream) const;
 
+        // Write Polygon fields to output stream without building the object
+        static void writeTo(OutputStream& stream, model::Span<const model::Vec2> vertices, const debugging::Color& color);
+
         // Get string representation of Polygon
         std::string toString() const;
     };
@@ -291,6 +299,9 @@ namespace debugging {
         // Write PolyLine to output stream
         void writeTo(OutputStream& stream) const;
 
+        // Write PolyLine fields to output stream without building the object
+        static void writeTo(OutputStream& stream, model::Span<const model::Vec2> vertices, double width, const debugging::Color& color);
+
         // Get string representation of PolyLine
         std::string toString() const;
     };
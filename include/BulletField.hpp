@@ -0,0 +1,50 @@
+#ifndef _BULLET_FIELD_HPP_
+#define _BULLET_FIELD_HPP_
+
+#include "ProjectileBatch.hpp"
+#include "ObstacleGrid.hpp"
+#include <vector>
+
+// Flight of projectiles over a rollout horizon. Where a projectile is on every tick and
+// when an obstacle or the end of its life stops it does not depend on the unit, so it is
+// computed once and then only read by all the rollouts against the same projectiles.
+// Projectiles are ordered by the tick they stop at, latest first: the ones still flying
+// at a tick are a prefix of the first frame and keep their index for the whole horizon.
+// T is the precision the flight is computed and stored in.
+template<typename T>
+class BulletFieldT {
+public:
+    void build(const ProjectileBatch& bullets, const ObstacleGrid& obstacle_grid, int ticks, double delta_time);
+
+    int ticks() const { return (int)frames.size(); }
+    // Projectiles at the start, every frame index is below it
+    size_t size() const { return frames.empty() ? 0 : frames[0].size(); }
+    size_t paddedSize() const { return stride; }
+
+    // Projectiles flying at the start of tick, where they are then
+    const ProjectileBatchT<T>& frame(int tick) const { return frames[tick]; }
+    // Time into tick at which a projectile of its frame hits an obstacle, or NO_HIT
+    const T* obstacleHits(int tick) const { return obstacle_hits.data() + tick * stride; }
+
+private:
+    // Moves batch one tick on and kills what an obstacle or the end of life stops there
+    void step(ProjectileBatchT<T>& batch, T delta_time, T* hits) const;
+
+    std::vector<ProjectileBatchT<T>> frames;
+    std::vector<T> obstacle_hits;
+    size_t stride = 0;
+
+    std::vector<const model::Obstacle*> near_obstacles;
+    std::vector<const model::Obstacle*> bullet_obstacles;
+    ProjectileBatchT<T> flight;
+    std::vector<int> stop_tick;
+    std::vector<size_t> order;
+};
+
+// Instantiated in BulletField.cpp
+extern template class BulletFieldT<double>;
+extern template class BulletFieldT<float>;
+
+typedef BulletFieldT<double> BulletField;
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef _CANDIDATE_GENERATOR_HPP_
+#define _CANDIDATE_GENERATOR_HPP_
+
+#include "Plan.hpp"
+#include "model/Vec2.hpp"
+#include <climits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit state a candidate search starts from
+struct CandidateContext {
+    // Move direction at angle 0 of the fan, not necessarily normalized
+    model::Vec2 velocity;
+    // Target velocity is the rotated velocity times speed
+    double speed = 0;
+    // Current view direction of the unit
+    model::Vec2 direction;
+    // Ticks a rollout lasts
+    int horizon = 0;
+    // Best plan of the previous tick shifted to the current one, if there is one
+    const Plan* warm_plan = nullptr;
+    // Seed of randomized generators, the same seed gives the same candidates
+    unsigned seed = 0;
+};
+
+// Source of dodge candidates for one unit. The search runs in rounds: next() appends
+// a round of plans, the strategy simulates them and reports their damage through
+// feedback() before it asks for the next round. Instances keep state between calls,
+// so every planning thread needs its own.
+class CandidateGenerator {
+public:
+    // Damage reported for candidates the deadline left no time for
+    static constexpr int NOT_EVALUATED = INT_MAX;
+    // Rollouts per unit when the budget is not given
+    static constexpr int DEFAULT_BUDGET = 120;
+
+    explicit CandidateGenerator(int budget) : budget(budget > 0 ? budget : DEFAULT_BUDGET) {}
+    virtual ~CandidateGenerator() = default;
+
+    // "fan", "adaptive" or "cem", throws on anything else
+    static std::unique_ptr<CandidateGenerator> create(const std::string& name, int budget);
+
+    virtual void begin(const CandidateContext& context) = 0;
+    // Append the next round to plans, false once the search is over
+    virtual bool next(std::vector<Plan>& plans) = 0;
+    virtual void feedback(const Plan* /*plans*/, const int* /*damages*/, size_t /*count*/) {}
+
+protected:
+    int budget;
+};
+
+// Every move direction of a fan combined with every view direction of another fan,
+// once without action and once aiming without shooting, as single order plans. Sizes
+// keep the 10:6 ratio of the original search and fill the budget in a single round.
+class UniformFanGenerator : public CandidateGenerator {
+public:
+    explicit UniformFanGenerator(int budget);
+
+    void begin(const CandidateContext& context) override;
+    bool next(std::vector<Plan>& plans) override;
+
+    // Append the fan candidates for context
+    static void append(const CandidateContext& context, const std::vector<model::Vec2>& velocity_fan, const std::vector<model::Vec2>& view_fan, std::vector<Plan>& plans);
+    // Fans whose product with both actions fits into budget
+    static void makeFans(int budget, std::vector<model::Vec2>& velocity_fan, std::vector<model::Vec2>& view_fan);
+
+private:
+    CandidateContext context;
+    std::vector<model::Vec2> velocity_fan;
+    std::vector<model::Vec2> view_fan;
+    bool done = false;
+};
+
+// Coarse uniform fan over half of the budget, then rounds that turn the move and the
+// view direction of the first segment of the best candidates not refined yet by half
+// of the previous step
+class AdaptiveGenerator : public CandidateGenerator {
+public:
+    explicit AdaptiveGenerator(int budget);
+
+    void begin(const CandidateContext& context) override;
+    bool next(std::vector<Plan>& plans) override;
+    void feedback(const Plan* plans, const int* damages, size_t count) override;
+
+private:
+    static const int PARENTS = 4;
+
+    struct Scored {
+        Plan plan;
+        int damage;
+        bool refined;
+    };
+
+    CandidateContext context;
+    std::vector<model::Vec2> velocity_fan;
+    std::vector<model::Vec2> view_fan;
+    std::vector<Scored> scored;
+    double velocity_step = 0;
+    double view_step = 0;
+    int spent = 0;
+};
+
+// Cross-entropy method over two segment plans: move and view angles of both segments
+// and the switch tick are sampled from normal distributions, aiming of each segment
+// from a probability, and all of them are refitted to the elite of every round.
+// The previous best plan, if any, centers the first round.
+class CrossEntropyGenerator : public CandidateGenerator {
+public:
+    explicit CrossEntropyGenerator(int budget);
+
+    void begin(const CandidateContext& context) override;
+    bool next(std::vector<Plan>& plans) override;
+    void feedback(const Plan* plans, const int* damages, size_t count) override;
+
+private:
+    static const int ROUNDS = 4;
+    static const int SEGMENTS = 2;
+    static constexpr double MIN_SIGMA = 0.05;
+
+    struct Sample {
+        // Move and view angle of every segment
+        double angles[SEGMENTS][2];
+        bool aim[SEGMENTS];
+        int switch_tick;
+    };
+
+    CandidateContext context;
+    std::mt19937 rng;
+    std::vector<Sample> samples;
+    double speed = 0;
+    double angle_mean[SEGMENTS][2];
+    double angle_sigma[SEGMENTS][2];
+    double aim_probability[SEGMENTS];
+    double switch_mean = 0;
+    double switch_sigma = 0;
+    int spent = 0;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef _DANGER_MAP_HPP_
+#define _DANGER_MAP_HPP_
+
+#include "BulletField.hpp"
+#include "model/Vec2.hpp"
+#include "model/Zone.hpp"
+#include <cmath>
+#include <vector>
+
+// Coarse grid over the area a unit can reach within the horizon, one layer per tick.
+// A cell is marked on a tick when some bullet of the field passes close enough during
+// that tick to hit a unit starting anywhere in the cell and moving at most margin on
+// the way. Unmarked cells are safe for sure, marked ones only may be hit. Cells lying
+// wholly in the zone damage ring are flagged separately, independently of the tick.
+class DangerMap {
+public:
+    template<typename T>
+    void build(
+        const BulletFieldT<T>& field,
+        const model::Zone& zone,
+        const model::Vec2& center,
+        double reach,
+        double cell_size,
+        double unit_radius,
+        double margin,
+        double delta_time);
+
+    // False only if no bullet can hit a unit at position on tick that moves at most travel during it
+    bool mayHit(const model::Vec2& position, int tick, double travel) const {
+        int cell = cellAt(position);
+        if (cell < 0 || tick >= ticks || travel > margin) {
+            return true;
+        }
+        return marks[tick * cells + cell] != 0;
+    }
+
+    // True only if a unit at position takes zone damage
+    bool outsideZone(const model::Vec2& position) const {
+        int cell = cellAt(position);
+        return cell >= 0 && zone_cells[cell] != 0;
+    }
+
+private:
+    int cellAt(const model::Vec2& position) const {
+        int x = (int)std::floor((position.x - origin.x) / cell_size);
+        int y = (int)std::floor((position.y - origin.y) / cell_size);
+        if (x < 0 || y < 0 || x >= width || y >= width) {
+            return -1;
+        }
+        return y * width + x;
+    }
+
+    model::Vec2 origin;
+    double cell_size = 1;
+    double margin = 0;
+    int width = 0;
+    int cells = 0;
+    int ticks = 0;
+    std::vector<char> marks;
+    std::vector<char> zone_cells;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef _DEADLINE_HPP_
+#define _DEADLINE_HPP_
+
+#include <algorithm>
+#include <chrono>
+
+// Point in time after which anytime searches must stop and return their best result
+class Deadline {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    Deadline() : at(Clock::time_point::max()) {}
+    explicit Deadline(Clock::time_point at) : at(at) {}
+
+    static Deadline in(std::chrono::microseconds budget) {
+        return Deadline(Clock::now() + budget);
+    }
+
+    bool unlimited() const { return at == Clock::time_point::max(); }
+
+    bool expired() const { return !unlimited() && Clock::now() >= at; }
+
+    std::chrono::microseconds remaining() const {
+        if (unlimited()) {
+            return std::chrono::microseconds::max();
+        }
+        return std::max(std::chrono::microseconds(0), std::chrono::duration_cast<std::chrono::microseconds>(at - Clock::now()));
+    }
+
+    // Equal share of the time left when it has to be split between parts sequential searches
+    Deadline share(int parts) const {
+        if (unlimited() || parts <= 1) {
+            return *this;
+        }
+        return Deadline::in(remaining() / parts);
+    }
+
+private:
+    Clock::time_point at;
+};
+
+#endif
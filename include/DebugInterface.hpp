@@ -2,26 +2,43 @@
 #define _DEBUG_INTERFACE_HPP_
 
 #include "stream/TcpStream.hpp"
+#include "stream/BufferStream.hpp"
 #include "debugging/DebugCommand.hpp"
 #include "debugging/DebugState.hpp"
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
 
+// Debug commands are batched in memory and sent in one write on flush(). Add commands
+// beyond bytesPerTick (0 means no limit) of a batch are dropped.
 class DebugInterface {
 public:
-    DebugInterface(TcpStream* stream);
+    DebugInterface(TcpStream* stream, size_t bytesPerTick = 0);
+    ~DebugInterface();
 
-    void addPlacedText(model::Vec2 position, std::string text, model::Vec2 alignment, double size, debugging::Color color);
+    // Move encoding and socket writes to a background thread. Draw calls then only
+    // queue compact records, sendPending() waits until the thread has caught up.
+    void startWriter(size_t queueCapacity = 16 * 1024);
+
+    void addPlacedText(model::Vec2 position, std::string_view text, model::Vec2 alignment, double size, debugging::Color color);
+    // Placed text of a number formatted on the stack
+    void addPlacedNumber(model::Vec2 position, int value, model::Vec2 alignment, double size, debugging::Color color);
+    void addPlacedNumber(model::Vec2 position, double value, int precision, model::Vec2 alignment, double size, debugging::Color color);
     void addCircle(model::Vec2 position, double radius, debugging::Color color);
     void addGradientCircle(model::Vec2 position, double radius, debugging::Color innerColor, debugging::Color outerColor);
     void addRing(model::Vec2 position, double radius, double width, debugging::Color color);
     void addPie(model::Vec2 position, double radius, double startAngle, double endAngle, debugging::Color color);
     void addArc(model::Vec2 position, double radius, double width, double startAngle, double endAngle, debugging::Color color);
     void addRect(model::Vec2 bottomLeft, model::Vec2 size, debugging::Color color);
-    void addPolygon(std::vector<model::Vec2> vertices, debugging::Color color);
+    void addPolygon(model::Span<const model::Vec2> vertices, debugging::Color color);
     void addGradientPolygon(std::vector<debugging::ColoredVertex> vertices);
     void addSegment(model::Vec2 firstEnd, model::Vec2 secondEnd, double width, debugging::Color color);
     void addGradientSegment(model::Vec2 firstEnd, debugging::Color firstColor, model::Vec2 secondEnd, debugging::Color secondColor, double width);
-    void addPolyLine(std::vector<model::Vec2> vertices, double width, debugging::Color color);
+    void addPolyLine(model::Span<const model::Vec2> vertices, double width, debugging::Color color);
     void addGradientPolyLine(std::vector<debugging::ColoredVertex> vertices, double width);
     void add(debugging::DebugData debugData);
     void clear();
@@ -30,8 +47,56 @@ public:
     void send(debugging::DebugCommand command);
     debugging::DebugState getState();
 
+    // Write out commands batched since the last flush, so they reach the server
+    // before the next message of the client
+    void sendPending();
+    // Add commands dropped by the byte limit so far
+    size_t droppedCommands() const { return dropped; }
+
 private:
+    // Draw call queued for the writer thread, common primitives are stored inline
+    struct Record {
+        enum Kind { ADD_CIRCLE, ADD_RING, ADD_SEGMENT, ADD_POLY_LINE, ADD_PLACED_TEXT, COMMAND, FLUSH, SEND_PENDING, STOP };
+        static const size_t TEXT_CAPACITY = 23;
+
+        Kind kind = COMMAND;
+        model::Vec2 first;
+        model::Vec2 second;
+        double radius = 0;
+        double width = 0;
+        debugging::Color color{0, 0, 0, 0};
+        char text[TEXT_CAPACITY];
+        unsigned char textLength = 0;
+        debugging::DebugCommand* command = nullptr;
+    };
+
+    void push(const Record& record);
+    void process(const Record& record);
+    void encode(const debugging::DebugCommand& command);
+    // Common primitives are written straight into the batch, without DebugCommand
+    void encodeCircle(model::Vec2 position, double radius, const debugging::Color& color);
+    void encodeRing(model::Vec2 position, double radius, double width, const debugging::Color& color);
+    void encodeSegment(model::Vec2 firstEnd, model::Vec2 secondEnd, double width, const debugging::Color& color);
+    void encodePolygon(model::Span<const model::Vec2> vertices, const debugging::Color& color);
+    void encodePolyLine(model::Span<const model::Vec2> vertices, double width, const debugging::Color& color);
+    void encodePlacedText(model::Vec2 position, std::string_view text, model::Vec2 alignment, double size, const debugging::Color& color);
+    size_t beginAdd(int dataTag);
+    void endAdd(size_t batchSize);
+    void writeBatch();
+    void writerLoop();
+
     TcpStream* stream;
+    BufferStream batch;
+    size_t bytesPerTick;
+    size_t dropped = 0;
+
+    std::unique_ptr<SpscQueue<Record>> queue;
+    std::thread writer;
+    std::mutex writerMutex;
+    std::condition_variable writerWake;
+    std::atomic<bool> writerSleeping{false};
+    size_t pushedRecords = 0;
+    std::atomic<size_t> processedRecords{0};
 };
 
 #endif
\ No newline at end of file
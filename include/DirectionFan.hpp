@@ -0,0 +1,65 @@
+#ifndef _DIRECTION_FAN_HPP_
+#define _DIRECTION_FAN_HPP_
+
+#include "model/Vec2.hpp"
+
+namespace fan {
+
+// sin by Taylor series, usable in constant expressions. The angle is folded into
+// [-pi/2, pi/2] first, where 20 terms are exact to double precision.
+constexpr double sin(double angle) {
+    while (angle > M_PI) {
+        angle -= 2 * M_PI;
+    }
+    while (angle < -M_PI) {
+        angle += 2 * M_PI;
+    }
+    if (angle > M_PI / 2) {
+        angle = M_PI - angle;
+    } else if (angle < -M_PI / 2) {
+        angle = -M_PI - angle;
+    }
+    double term = angle;
+    double sum = angle;
+    for (int i = 1; i < 20; ++i) {
+        term *= -angle * angle / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double angle) {
+    return sin(M_PI / 2 - angle);
+}
+
+constexpr model::Vec2 unitVector(double angle) {
+    return model::Vec2(cos(angle), sin(angle));
+}
+
+}
+
+// Unit vectors at angles 2 * pi * k / N, built at compile time. Rotating a vector
+// by entry k turns it k steps of the fan with one complex multiplication.
+template<int N>
+class DirectionFan {
+public:
+    constexpr DirectionFan() {
+        for (int k = 0; k < N; ++k) {
+            directions[k] = fan::unitVector(2 * M_PI * k / N);
+        }
+    }
+
+    constexpr const model::Vec2& operator[](int k) const { return directions[k]; }
+    static constexpr int size() { return N; }
+
+private:
+    model::Vec2 directions[N] = {};
+};
+
+// Move directions tried while shooting, steps of pi / 8
+inline constexpr DirectionFan<16> FAN_16;
+
+// Per tick drift of the default direction
+inline constexpr model::Vec2 DEFAULT_DIR_STEP = fan::unitVector(M_PI / 2000);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _KINEMATICS_HPP_
+#define _KINEMATICS_HPP_
+
+#include "model/Constants.hpp"
+#include <optional>
+#include <vector>
+
+// Unit motion limits of one weapon, precomputed for a fixed tick length
+struct WeaponKinematics {
+    // Change of aim per tick while aiming or relaxing
+    double aim_step = 0;
+    // Speed limits are scaled by 1 - speed_slope * aim
+    double speed_slope = 0;
+    // Rotation limit per tick in radians is rotation_step - rotation_slope * aim
+    double rotation_step = 0;
+    double rotation_slope = 0;
+    // cos and sin of the rotation limit at aim 0 and at aim 1
+    double idle_cos = 1;
+    double idle_sin = 0;
+    double aimed_cos = 1;
+    double aimed_sin = 0;
+    // cos and sin of the change of the rotation limit after one aim step
+    double aim_step_cos = 1;
+    double aim_step_sin = 0;
+};
+
+// Table of WeaponKinematics built from Constants, with one extra entry for units
+// without a weapon. The speed circle only depends on aim through a common scale,
+// so its shape is stored once.
+class KinematicsTable {
+public:
+    void build(const model::Constants& constants, double delta_time);
+
+    const WeaponKinematics& weapon(const std::optional<int>& weapon) const {
+        return weapon ? weapons[*weapon] : weapons.back();
+    }
+
+    // Offset of the speed circle center over its radius
+    double offset_ratio = 0;
+    // Speed limit towards a direction is scale * sqrt(len_base - len_cos * cos_c), see Unit::getVelocity
+    double len_base = 0;
+    double len_cos = 0;
+    // Velocity change allowed per tick and its square
+    double max_velocity_shift = 0;
+    double max_velocity_shift_sq = 0;
+
+private:
+    std::vector<WeaponKinematics> weapons;
+};
+
+#endif
@@ -2,6 +2,15 @@
 #define _MY_STRATEGY_HPP_
 
 #include "Simulator.hpp"
+#include "CandidateGenerator.hpp"
+#include "ProjectileBatch.hpp"
+#include "DangerMap.hpp"
+#include "ObstacleGrid.hpp"
+#include "SlotMap.hpp"
+#include "StrategyOptions.hpp"
+#include "ThreadPool.hpp"
+#include "Deadline.hpp"
+#include "Profiler.hpp"
 #include "DebugInterface.hpp"
 #include "model/Constants.hpp"
 #include "model/Game.hpp"
@@ -24,19 +33,52 @@ class MyStrategy {
 private:
     static model::Constants* constants_;
 public:
-    MyStrategy(const model::Constants& constants);
+    MyStrategy(const model::Constants& constants, const StrategyOptions& options = StrategyOptions());
+    // The simulators and the obstacle grid point into the strategy, it stays where it was built
+    MyStrategy(const MyStrategy&) = delete;
+    MyStrategy& operator=(const MyStrategy&) = delete;
+    MyStrategy(MyStrategy&&) = delete;
+    MyStrategy& operator=(MyStrategy&&) = delete;
     model::Order getOrder(model::Game& game, DebugInterface* debugInterface);
 
-    std::optional<model::UnitOrder> looting(const model::Unit& myUnit, const model::Zone& zone);
+    // Unit id -> id of the loot it is going for this tick
+    typedef std::unordered_map<int, int> LootReservations;
+
+    std::optional<model::UnitOrder> looting(const model::Unit& myUnit, const model::Zone& zone, LootReservations& busy_loot) const;
     std::optional<model::UnitOrder> healing(const model::Unit& myUnit) const;
 
     void shooting(
         const model::Unit& myUnit,
         const model::Unit* nearest_enemy,
-        std::vector<const model::Obstacle*>& obstacles,
-        std::vector<model::UnitOrder>& orders);
+        std::vector<model::UnitOrder>& orders,
+        Simulator& simulator);
+
+    Deadline tickDeadline(const model::Zone& zone) const;
+    void planTeam(const std::vector<model::Unit*>& team, const model::Zone& zone, const Deadline& deadline, std::unordered_map<int, model::UnitOrder>& actions);
+    // Best dodge plan of a unit with the tick it was made for, where it was predicted to
+    // take the unit and the damage it was predicted to take on the way
+    struct CachedPlan {
+        int tick;
+        Plan plan;
+        std::vector<model::Vec2> trajectory;
+        int damage;
+    };
 
-    model::UnitOrder getUnitOrder(model::Unit& myUnit, const model::Zone& zone);
+    // dodge_plan is set to the picked plan when it came from the dodge search
+    model::UnitOrder getUnitOrder(model::Unit& myUnit, const model::Zone& zone, Simulator& simulator, CandidateGenerator& generator, LootReservations& busy_loot, const Deadline& deadline, std::optional<CachedPlan>& dodge_plan);
+    void rememberPlan(int unit_id, std::optional<CachedPlan>& plan);
+    // Cached plan of the unit shifted to the current tick, unless it expired or the unit
+    // is no longer where the plan said it would be
+    std::optional<Plan> cachedPlan(const model::Unit& myUnit) const;
+
+    // Order in which candidates are simulated: the first strategic_count plans as they are,
+    // then the rest sorted by a cheap estimate of how often their path crosses danger
+    std::vector<size_t> prioritizeCandidates(
+        const model::Unit& myUnit,
+        const std::vector<Plan>& plans,
+        size_t strategic_count,
+        const DangerMap& danger_map,
+        int ticks) const;
 
     static model::Constants* getConstants();
 
@@ -44,17 +86,34 @@ public:
     void finish();
 
     Simulator simulator;
+    // One simulator per pool worker, each with its own scratch buffers
+    std::vector<Simulator> worker_simulators;
+    // Dodge candidate search of the serial planner and of every pool worker
+    std::unique_ptr<CandidateGenerator> generator;
+    std::vector<std::unique_ptr<CandidateGenerator>> worker_generators;
+    // Unit id -> its last dodge plan. The plan is simulated again on the next tick and kept
+    // without any search while it stays damage free, otherwise it seeds the search.
+    std::unordered_map<int, CachedPlan> plan_cache;
+    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<Profiler> profiler;
+    StrategyOptions options;
     model::Constants constants;
-    std::unordered_map<int, model::Projectile> bullets;
-    std::unordered_map<int, model::Unit> enemies;
-    std::unordered_map<int, model::Loot> loots;
-    std::unordered_map<int, int> busy_loot;
+    ObstacleGrid obstacle_grid;
+    // What is known of the world, kept from the ticks it was last seen
+    SlotMap<model::Projectile> bullets;
+    SlotMap<model::Unit> enemies;
+    SlotMap<model::Loot> loots;
+    LootReservations busy_loot;
     std::vector<model::Unit*> my_units;
 
     DebugInterface *debugInterface = nullptr;
     double delta_time;
     double radius_treshold = 100.0;
-    int elapsed_time = 0.0;
+    int planned_ticks = 0;
+    long long spent_time_us = 0;
+    long long skipped_candidates = 0;
+    long long total_team_latency = 0;
+    long long max_team_latency = 0;
     model::Vec2 default_dir{1, 0};
 };
 
@@ -0,0 +1,58 @@
+#ifndef _OBSTACLE_GRID_HPP_
+#define _OBSTACLE_GRID_HPP_
+
+#include "model/Obstacle.hpp"
+#include "model/Vec2.hpp"
+#include <vector>
+
+// Static uniform grid over the map obstacles. Every obstacle is stored in all
+// cells its bounding box overlaps. Query results are ordered by the obstacle
+// index in Constants::obstacles, so callers see the same order as a linear scan.
+class ObstacleGrid {
+public:
+    // Cell size the strategy builds its grid with
+    static constexpr double DEFAULT_CELL = 5.0;
+
+    void build(const std::vector<model::Obstacle>& obstacles, double cell_size);
+
+    // Obstacles closer than radius to center (strictly, edge to edge)
+    void queryCircle(
+        const model::Vec2& center,
+        double radius,
+        bool blocking_shots_only,
+        std::vector<const model::Obstacle*>& out) const;
+
+    // Obstacles closer than radius to the segment from..to
+    void querySegment(
+        const model::Vec2& from,
+        const model::Vec2& to,
+        double radius,
+        bool blocking_shots_only,
+        std::vector<const model::Obstacle*>& out) const;
+
+    // Obstacles whose bounding box overlaps the given box
+    void queryBox(
+        const model::Vec2& min,
+        const model::Vec2& max,
+        bool blocking_shots_only,
+        std::vector<const model::Obstacle*>& out) const;
+
+    bool empty() const { return obstacles == nullptr || obstacles->empty(); }
+
+private:
+    template<typename Accept>
+    void query(const model::Vec2& min, const model::Vec2& max, bool blocking_shots_only, std::vector<const model::Obstacle*>& out, Accept accept) const;
+
+    int cellX(double x) const;
+    int cellY(double y) const;
+
+    const std::vector<model::Obstacle>* obstacles = nullptr;
+    model::Vec2 origin;
+    double cell_size = 1;
+    int width = 0;
+    int height = 0;
+    std::vector<int> cell_start;
+    std::vector<int> cell_items;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef _PLAN_HPP_
+#define _PLAN_HPP_
+
+#include "model/InlineVector.hpp"
+#include "model/UnitOrder.hpp"
+#include <algorithm>
+#include <climits>
+
+// One order held for a number of ticks
+struct PlanSegment {
+    model::UnitOrder order;
+    int ticks;
+
+    PlanSegment() : order(model::Vec2(0, 0), model::Vec2(1, 0), std::nullopt), ticks(0) {}
+    PlanSegment(const model::UnitOrder& order, int ticks) : order(order), ticks(ticks) {}
+};
+
+// Orders for consecutive stretches of a rollout, starting at the tick it is planned
+// for. The last segment lasts until the end of the horizon whatever its ticks say.
+class Plan {
+public:
+    static const size_t MAX_SEGMENTS = 4;
+
+    Plan() = default;
+    explicit Plan(const model::UnitOrder& order) { add(order, INT_MAX); }
+
+    void add(const model::UnitOrder& order, int ticks) { segments.emplace_back(PlanSegment(order, ticks)); }
+
+    // Order sent to the server for the current tick
+    const model::UnitOrder& first() const { return segments[0].order; }
+    model::UnitOrder& first() { return segments[0].order; }
+
+    // The same plan as seen the given number of ticks later
+    void shift(int ticks) {
+        size_t dropped = 0;
+        while (ticks > 0 && dropped + 1 < segments.size()) {
+            int step = std::min(ticks, segments[dropped].ticks);
+            segments[dropped].ticks -= step;
+            ticks -= step;
+            if (segments[dropped].ticks == 0) {
+                ++dropped;
+            }
+        }
+        if (dropped > 0) {
+            std::copy(segments.begin() + dropped, segments.end(), segments.begin());
+            segments.resize(segments.size() - dropped);
+        }
+    }
+
+    model::InlineVector<PlanSegment, MAX_SEGMENTS> segments;
+};
+
+#endif
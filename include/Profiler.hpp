@@ -0,0 +1,117 @@
+#ifndef _PROFILER_HPP_
+#define _PROFILER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Log-linear histogram in the spirit of HdrHistogram: 32 linear sub-buckets per power of two,
+// so any recorded value is reported with at most ~3% relative error
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+    // Smallest bucket bound covering at least the given fraction of the samples
+    uint64_t percentile(double fraction) const;
+
+private:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    static size_t bucketOf(uint64_t value);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+    std::vector<uint64_t> buckets;
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+};
+
+// Per-phase latency histograms and per-tick counters of the strategy. Samples go to a slot
+// of the recording pool worker, so timers inside parallel loops never contend.
+class Profiler {
+public:
+    enum Phase {
+        TICK,
+        INGESTION,
+        TEAM_PLAN,
+        UNIT_ORDER,
+        SHOOTING,
+        LOOTING,
+        SIMULATE_BATCH,
+        ROLLOUT,
+        WORLD_UPDATE,
+        SERIALIZATION,
+        PHASE_COUNT
+    };
+
+    enum Counter {
+        ROLLOUTS,
+        SIMULATED_BULLETS,
+        RECV_CALLS,
+        SEND_CALLS,
+        PLANNED_DAMAGE,
+        PLAN_CACHE_HITS,
+        PRUNED_TICKS,
+        COUNTER_COUNT
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Times the enclosing block into one phase
+    class Scope {
+    public:
+        Scope(Profiler& profiler, Phase phase) : profiler(profiler), phase(phase), start(Clock::now()) {}
+        ~Scope() { profiler.record(phase, start); }
+
+    private:
+        Profiler& profiler;
+        Phase phase;
+        Clock::time_point start;
+    };
+
+    explicit Profiler(size_t workers);
+
+    // Additionally write one JSON line per tick to the given file
+    void stream(const std::string& path);
+
+    void record(Phase phase, uint64_t ns);
+    void record(Phase phase, Clock::time_point start) {
+        record(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+    // Counters belong to the current tick and are only added outside of parallel loops
+    void add(Counter counter, uint64_t value);
+
+    // Closes the previous tick (its counters and streamed line) and opens the next one
+    void beginTick(int tick);
+    void endTicks();
+
+    void dump(std::ostream& out) const;
+
+    static const char* phaseName(Phase phase);
+    static const char* counterName(Counter counter);
+
+private:
+    struct Slot {
+        LatencyHistogram phases[PHASE_COUNT];
+        uint64_t tick_phase_ns[PHASE_COUNT] = {};
+    };
+
+    void closeTick();
+
+    std::vector<Slot> slots;
+    uint64_t tick_counters[COUNTER_COUNT] = {};
+    LatencyHistogram counters[COUNTER_COUNT];
+    int current_tick = -1;
+    std::ofstream stream_file;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef _PROJECTILE_BATCH_HPP_
+#define _PROJECTILE_BATCH_HPP_
+
+#include "model/Constants.hpp"
+#include "model/Projectile.hpp"
+#include "model/Vec2.hpp"
+#include <limits>
+#include <vector>
+
+// Structure-of-arrays copy of projectiles for the simulator hot loop, in double or
+// float precision. Arrays are padded to a multiple of LANES with dead entries (life < 0),
+// so the kernels never need a scalar tail. LANES covers a full AVX2 register.
+template<typename T>
+class ProjectileBatchT {
+public:
+    static const size_t LANES = 32 / sizeof(T);
+    static constexpr T NO_HIT = std::numeric_limits<T>::infinity();
+
+    void clear();
+    void add(const model::Projectile& projectile, const model::Constants& constants);
+    // Appends a copy of entry i of other
+    template<typename U>
+    void add(const ProjectileBatchT<U>& other, size_t i);
+    void assign(const std::vector<model::Projectile>& projectiles, const model::Constants& constants);
+
+    size_t size() const { return count; }
+    size_t paddedSize() const { return x.size(); }
+    bool alive(size_t i) const { return life[i] > 0; }
+    void kill(size_t i) { life[i] = -1; }
+
+    // Drops dead projectiles, keeping the order of the alive ones
+    void compact();
+
+    // Axis-aligned box covering every alive projectile's path over the next time units
+    void sweptBounds(T time, model::Vec2T<T>& min, model::Vec2T<T>& max) const;
+
+    // For every projectile writes the earliest time in [0, max_time] (and within its life time)
+    // when it touches a circle of squared radius radius_sq moving with velocity, or NO_HIT.
+    // Mirrors Projectile::hasHit. With keep_min the result is min-combined into out instead.
+    void sweptCircleHits(
+        const model::Vec2T<T>& center,
+        const model::Vec2T<T>& velocity,
+        T radius_sq,
+        T max_time,
+        T* out,
+        bool keep_min) const;
+
+    std::vector<int> ids;
+    std::vector<T> x;
+    std::vector<T> y;
+    std::vector<T> vx;
+    std::vector<T> vy;
+    std::vector<T> life;
+    std::vector<T> damage;
+
+private:
+    void pad();
+
+    size_t count = 0;
+};
+
+template<typename T>
+template<typename U>
+void ProjectileBatchT<T>::add(const ProjectileBatchT<U>& other, size_t i) {
+    size_t k = count++;
+    pad();
+
+    ids[k] = other.ids[i];
+    x[k] = T(other.x[i]);
+    y[k] = T(other.y[i]);
+    vx[k] = T(other.vx[i]);
+    vy[k] = T(other.vy[i]);
+    life[k] = T(other.life[i]);
+    damage[k] = T(other.damage[i]);
+}
+
+// Instantiated in ProjectileBatch.cpp
+extern template class ProjectileBatchT<double>;
+extern template class ProjectileBatchT<float>;
+
+typedef ProjectileBatchT<double> ProjectileBatch;
+
+#endif
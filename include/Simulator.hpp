@@ -6,34 +6,127 @@
 #include "model/Projectile.hpp"
 #include "model/UnitOrder.hpp"
 #include "model/Zone.hpp"
+#include "ProjectileBatch.hpp"
+#include "ObstacleGrid.hpp"
+#include "BulletField.hpp"
+#include "DangerMap.hpp"
+#include "Kinematics.hpp"
+#include "Plan.hpp"
 #include "utility"
+#include <climits>
+#include <type_traits>
+#include <vector>
 
 class Simulator {
 public:
+    // Upper limit for simulated_ticks, scratch buffers are sized for it once
+    static constexpr int MAX_SIMULATED_TICKS = 120;
+
     Simulator(const model::Constants& constants);
 
     std::optional<const model::Obstacle*> SimulateMovement(
         model::Unit& unit,
-        model::UnitOrder& order,
-        const std::vector<const model::Obstacle*>& obstacles,
+        const model::UnitOrder& order,
         int cur_tick);
 
     void SimulateEnemyMovement(
         model::Unit& unit,
-        std::vector<const model::Obstacle*>& obstacles,
         int cur_tick);
 
+    // Rolls the unit out for simulated_ticks ticks against a private copy of bullets.
+    // Returns total damage, per-tick damage is left in tick_damage and the unit position
+    // after every tick in trajectory.
+    int Simulate(
+        model::Unit& unit,
+        const model::UnitOrder& order,
+        const ProjectileBatch& bullets,
+        const model::Zone& zone);
+
+    // Same rollout, switching orders at the segment boundaries of the plan
+    int Simulate(
+        model::Unit& unit,
+        const Plan& plan,
+        const ProjectileBatch& bullets,
+        const model::Zone& zone);
+
+    // Same rollout against the flight of bullets precomputed for simulated_ticks ticks,
+    // cheaper when many rollouts share the same bullets. Ticks the danger map built from
+    // the same field proves safe skip the hit tests. The rollout stops as soon as its
+    // damage can no longer get down to bound and then returns a value above bound, with
+    // the ticks it did not simulate in skipped_ticks.
+    template<typename T>
     int Simulate(
         model::Unit& unit,
-        model::UnitOrder& order,
-        std::vector<model::Projectile>& bullets,
-        const std::vector<const model::Obstacle*>& obstacles,
+        const Plan& plan,
+        const BulletFieldT<T>& field,
         const model::Zone& zone,
-        int ticks) const;
+        const DangerMap* danger = nullptr,
+        int bound = INT_MAX);
+
+    void setSimulatedTicks(int ticks);
+    void setDeltaTime(double time);
 
     model::Constants constants;
     int started_tick = 0;
+    int simulated_ticks = 30;
     double delta_time;
+    const ObstacleGrid* obstacle_grid = nullptr;
+
+    std::vector<int> tick_damage;
+    std::vector<model::Vec2> trajectory;
+    int skipped_ticks = 0;
+    // Bonus the shot of the last rollout took off its damage, 0 if it did not shoot
+    int shot_credit = 0;
+
+    // Work counters for profiling, collected and reset by the strategy every tick
+    long long rollouts = 0;
+    long long simulated_bullets = 0;
+    // Predicted damage taken by the orders picked by a dodge search, a quality measure of the
+    // search. The shot bonus is not counted, so it never goes negative.
+    long long planned_damage = 0;
+    // Units that kept their cached plan instead of running a dodge search
+    long long plan_cache_hits = 0;
+    // Ticks of rollouts cut short by their bound
+    long long pruned_ticks = 0;
+    // Candidates of a dodge search left unevaluated by the deadline
+    long long skipped_candidates = 0;
+
+private:
+    // Parts of the order and of the rotation limit that carry over between ticks of a rollout
+    struct Motion {
+        const WeaponKinematics* weapon;
+        bool aiming;
+        model::Vec2 move_dir;
+        double target_speed;
+        model::Vec2 target_dir;
+        bool rotates;
+        double rotation_limit;
+        double limit_cos;
+        double limit_sin;
+    };
+
+    Motion beginMotion(const model::Unit& unit, const model::UnitOrder& order) const;
+    void simulateRotation(model::Unit& unit, Motion& motion) const;
+    void simulateVelocity(model::Unit& unit, const model::UnitOrder& order, const Motion& motion) const;
+    // Obstacles the unit can touch during the next tick with its current velocity
+    const std::vector<const model::Obstacle*>& obstaclesInReach(const model::Unit& unit);
+    // Scratch for the unit hit times in the precision of the rollout
+    template<typename T>
+    std::vector<T>& hitBuffer() {
+        if constexpr (std::is_same_v<T, float>) {
+            return unit_hits_float;
+        } else {
+            return unit_hits;
+        }
+    }
+
+    std::vector<const model::Obstacle*> near_obstacles;
+
+    KinematicsTable kinematics;
+    BulletField field_scratch;
+    std::vector<double> unit_hits;
+    std::vector<float> unit_hits_float;
+    std::vector<char> hit_unit;
 };
 
-#endif
\ No newline at end of file
+#endif
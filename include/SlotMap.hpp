@@ -0,0 +1,126 @@
+#ifndef _SLOT_MAP_HPP_
+#define _SLOT_MAP_HPP_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Entities kept across ticks, keyed by their game id. Values are stored contiguously and
+// iterated as a plain array; removing one moves the last value into its place. A handle
+// names a slot that follows its value around, and stops resolving once the value is
+// removed because the slot generation moves on.
+template<typename T>
+class SlotMap {
+public:
+    struct Handle {
+        uint32_t slot = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    // Stores value under id, overwriting the one already there. Handles to it stay valid.
+    Handle assign(int id, const T& value) {
+        auto it = slot_of_id.find(id);
+        if (it != slot_of_id.end()) {
+            values[slots[it->second].dense] = value;
+            return {it->second, slots[it->second].generation};
+        }
+
+        uint32_t slot;
+        if (free_slots.empty()) {
+            slot = (uint32_t)slots.size();
+            slots.push_back({0, 0});
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+        slots[slot].dense = (uint32_t)values.size();
+        values.push_back(value);
+        dense_ids.push_back(id);
+        dense_slots.push_back(slot);
+        slot_of_id.emplace(id, slot);
+        return {slot, slots[slot].generation};
+    }
+
+    // Value of handle, nullptr when it has been removed since
+    T* get(Handle handle) {
+        if (handle.slot >= slots.size() || slots[handle.slot].generation != handle.generation) {
+            return nullptr;
+        }
+        return &values[slots[handle.slot].dense];
+    }
+
+    T& operator[](Handle handle) { return values[slots[handle.slot].dense]; }
+
+    T* find(int id) {
+        auto it = slot_of_id.find(id);
+        return it == slot_of_id.end() ? nullptr : &values[slots[it->second].dense];
+    }
+
+    const T* find(int id) const {
+        auto it = slot_of_id.find(id);
+        return it == slot_of_id.end() ? nullptr : &values[slots[it->second].dense];
+    }
+
+    bool erase(int id) {
+        auto it = slot_of_id.find(id);
+        if (it == slot_of_id.end()) {
+            return false;
+        }
+        removeAt(slots[it->second].dense);
+        return true;
+    }
+
+    // Calls predicate once on every value and removes the ones it returns true for
+    template<typename Predicate>
+    void eraseIf(Predicate predicate) {
+        for (size_t i = 0; i < values.size();) {
+            if (predicate(values[i])) {
+                removeAt(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+
+    typename std::vector<T>::iterator begin() { return values.begin(); }
+    typename std::vector<T>::iterator end() { return values.end(); }
+    typename std::vector<T>::const_iterator begin() const { return values.begin(); }
+    typename std::vector<T>::const_iterator end() const { return values.end(); }
+
+private:
+    struct Slot {
+        uint32_t dense;
+        uint32_t generation;
+    };
+
+    void removeAt(size_t dense) {
+        uint32_t slot = dense_slots[dense];
+        slot_of_id.erase(dense_ids[dense]);
+        ++slots[slot].generation;
+        free_slots.push_back(slot);
+
+        size_t last = values.size() - 1;
+        if (dense != last) {
+            values[dense] = std::move(values[last]);
+            dense_ids[dense] = dense_ids[last];
+            dense_slots[dense] = dense_slots[last];
+            slots[dense_slots[dense]].dense = (uint32_t)dense;
+        }
+        values.pop_back();
+        dense_ids.pop_back();
+        dense_slots.pop_back();
+    }
+
+    std::vector<T> values;
+    // Game id and slot of every value
+    std::vector<int> dense_ids;
+    std::vector<uint32_t> dense_slots;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    std::unordered_map<int, uint32_t> slot_of_id;
+};
+
+#endif
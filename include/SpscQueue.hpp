@@ -0,0 +1,56 @@
+#ifndef _SPSC_QUEUE_HPP_
+#define _SPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread
+template<typename T>
+class SpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        items.resize(size);
+        mask = size - 1;
+    }
+
+    // Producer side, false when the queue is full
+    bool push(const T& item) {
+        size_t tail = write_index.load(std::memory_order_relaxed);
+        if (tail - read_index.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        items[tail & mask] = item;
+        write_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, false when the queue is empty
+    bool pop(T& item) {
+        size_t head = read_index.load(std::memory_order_relaxed);
+        if (head == write_index.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[head & mask];
+        read_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return read_index.load(std::memory_order_acquire) == write_index.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> items;
+    size_t mask;
+    // Separate cache lines, so the two threads do not bounce one line between them
+    alignas(64) std::atomic<size_t> write_index{0};
+    alignas(64) std::atomic<size_t> read_index{0};
+};
+
+#endif
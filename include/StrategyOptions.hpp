@@ -0,0 +1,65 @@
+#ifndef _STRATEGY_OPTIONS_HPP_
+#define _STRATEGY_OPTIONS_HPP_
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+// Runtime knobs of the strategy, filled from the command line of the client and the replayer
+struct StrategyOptions {
+    // Threads evaluating candidate orders, 0 means one per hardware thread
+    int threads = 1;
+    // Plan all units of the team concurrently instead of one after another
+    bool parallel_units = false;
+    // Print the team decision latency of every tick
+    bool log_latency = false;
+    // Hard cap on planning time per tick in milliseconds, 0 disables deadlines
+    double tick_budget_ms = 150;
+    // Total planning time for the whole game in seconds (total_time_limit of the server)
+    double total_budget_s = 300;
+    // Part of the total budget held back for ticks the estimate does not see coming
+    double budget_reserve = 0.1;
+    // File receiving one line of phase timings and counters per tick, empty to disable
+    std::string profile_path;
+    // Dodge candidate search: "fan", "adaptive" or "cem"
+    std::string candidate_generator = "fan";
+    // Rollouts per unit for the dodge search, 0 means the generator default
+    int candidate_budget = 0;
+    // Bullet flight and hit tests in float instead of double, set by --precision float|double
+    bool float_precision = false;
+
+    // Consume argv[i] (and its value) if it is a strategy option, throws on an invalid value
+    bool parse(int argc, char* argv[], int& i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (arg == "--parallel-units") {
+            parallel_units = true;
+        } else if (arg == "--log-latency") {
+            log_latency = true;
+        } else if (arg == "--tick-budget-ms" && i + 1 < argc) {
+            tick_budget_ms = atof(argv[++i]);
+        } else if (arg == "--total-budget-s" && i + 1 < argc) {
+            total_budget_s = atof(argv[++i]);
+        } else if (arg == "--budget-reserve" && i + 1 < argc) {
+            budget_reserve = atof(argv[++i]);
+        } else if (arg == "--profile-file" && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (arg == "--candidates" && i + 1 < argc) {
+            candidate_generator = argv[++i];
+        } else if (arg == "--candidate-budget" && i + 1 < argc) {
+            candidate_budget = atoi(argv[++i]);
+        } else if (arg == "--precision" && i + 1 < argc) {
+            std::string precision = argv[++i];
+            if (precision != "float" && precision != "double") {
+                throw std::runtime_error("Unknown precision " + precision);
+            }
+            float_precision = precision == "float";
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif
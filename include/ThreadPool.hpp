@@ -0,0 +1,49 @@
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool for fork-join loops. The calling thread takes part as worker 0,
+// so a pool of size 1 has no threads at all and runs everything inline.
+class ThreadPool {
+public:
+    typedef std::function<void(size_t worker, size_t index)> Task;
+
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // Calls task(worker, index) for every index in [0, count) and waits for all of them.
+    // Nested calls from inside a task run inline on the calling worker.
+    void parallelFor(size_t count, const Task& task);
+
+    // Worker id of the calling thread inside parallelFor, 0 outside of it
+    static size_t currentWorker();
+
+private:
+    void workerLoop(size_t worker);
+    void runTasks(size_t worker);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const Task* task = nullptr;
+    size_t task_count = 0;
+    std::atomic<size_t> next_index{0};
+    size_t active = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+#endif
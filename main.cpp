@@ -1,16 +1,39 @@
 #include "DebugInterface.hpp"
 #include "MyStrategy.hpp"
+#include "StrategyOptions.hpp"
 #include "stream/TcpStream.hpp"
+#include "stream/RecordingStream.hpp"
 #include "codegame/ServerMessage.hpp"
 #include "codegame/ClientMessage.hpp"
+#include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
+
+// Connection knobs of the client itself
+struct ClientOptions
+{
+    // Copy of everything read from the server, empty to disable
+    std::string recordPath;
+    size_t socketBuffer = TcpStream::BUFFER_CAPACITY;
+    bool frameReads = false;
+    // Cap on debug drawing sent per tick, 0 means no cap
+    size_t debugBytesPerTick = 0;
+    // Encode and send debug drawing on a separate thread
+    bool asyncDebug = false;
+};
 
 class Runner
 {
 public:
-    Runner(const std::string &host, int port, const std::string &token) : tcpStream(host, port)
+    Runner(const std::string &host, int port, const std::string &token, const StrategyOptions &options, const ClientOptions &client)
+        : tcpStream(host, port, client.socketBuffer), options(options), debugBytesPerTick(client.debugBytesPerTick), asyncDebug(client.asyncDebug)
     {
+        tcpStream.setFrameReads(client.frameReads);
+        if (!client.recordPath.empty())
+        {
+            recorder.reset(new RecordingStream(tcpStream, client.recordPath));
+        }
         tcpStream.write(token);
         tcpStream.write(int(1));
         tcpStream.write(int(1));
@@ -19,29 +42,50 @@ public:
     }
     void run()
     {
-        DebugInterface debugInterface(&tcpStream);
+        DebugInterface debugInterface(&tcpStream, debugBytesPerTick);
+        if (asyncDebug)
+        {
+            debugInterface.startWriter();
+        }
         std::shared_ptr<MyStrategy> myStrategy = std::shared_ptr<MyStrategy>();
+        InputStream &input = recorder ? static_cast<InputStream &>(*recorder) : tcpStream;
+        // Kept between ticks so GetOrder is decoded into the same buffers every time
+        codegame::ServerMessage message = codegame::Finish();
         while (true)
         {
-            auto message = codegame::readServerMessage(tcpStream);
+            codegame::readServerMessage(input, message);
             if (const codegame::UpdateConstants *updateConstantsMessage = std::get_if<codegame::UpdateConstants>(&message))
             {
-                myStrategy.reset(new MyStrategy(updateConstantsMessage->constants));
+                myStrategy.reset(new MyStrategy(updateConstantsMessage->constants, options));
             }
             else if (codegame::GetOrder *getOrderMessage = std::get_if<codegame::GetOrder>(&message))
             {
                 codegame::ClientMessage message = codegame::OrderMessage(myStrategy->getOrder(getOrderMessage->playerView, getOrderMessage->debugAvailable ? &debugInterface : nullptr));
-                codegame::writeClientMessage(message, tcpStream);
-                tcpStream.flush();
+                {
+                    Profiler::Scope serialization(*myStrategy->profiler, Profiler::SERIALIZATION);
+                    debugInterface.sendPending();
+                    codegame::writeClientMessage(message, tcpStream);
+                    tcpStream.flush();
+                }
+                countSyscalls(*myStrategy->profiler);
             }
             else if (const codegame::Finish *finishMessage = std::get_if<codegame::Finish>(&message))
             {
+                if (recorder)
+                {
+                    recorder->flush();
+                }
                 myStrategy->finish();
+                if (debugInterface.droppedCommands() > 0)
+                {
+                    std::cout << "Debug commands dropped by the byte limit " << debugInterface.droppedCommands() << std::endl;
+                }
                 break;
             }
             else if (const codegame::DebugUpdate *debugUpdateMessage = std::get_if<codegame::DebugUpdate>(&message))
             {
                 myStrategy->debugUpdate(debugUpdateMessage->displayedTick, debugInterface);
+                debugInterface.sendPending();
                 codegame::ClientMessage message = codegame::DebugUpdateDone();
                 codegame::writeClientMessage(message, tcpStream);
                 tcpStream.flush();
@@ -54,14 +98,50 @@ public:
     }
 
 private:
+    // Socket calls since the previous tick, counted into the tick just answered
+    void countSyscalls(Profiler &profiler)
+    {
+        const TcpStream::Stats &stats = tcpStream.stats();
+        profiler.add(Profiler::RECV_CALLS, stats.recvCalls - countedStats.recvCalls);
+        profiler.add(Profiler::SEND_CALLS, stats.sendCalls - countedStats.sendCalls);
+        countedStats = stats;
+    }
+
     TcpStream tcpStream;
+    TcpStream::Stats countedStats;
+    std::unique_ptr<RecordingStream> recorder;
+    StrategyOptions options;
+    size_t debugBytesPerTick;
+    bool asyncDebug;
 };
 
 int main(int argc, char *argv[])
 {
-    std::string host = argc < 2 ? "127.0.0.1" : argv[1];
-    int port = argc < 3 ? 31001 : atoi(argv[2]);
-    std::string token = argc < 4 ? "0000000000000000" : argv[3];
-    Runner(host, port, token).run();
+    StrategyOptions options;
+    ClientOptions client;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (options.parse(argc, argv, i)) {
+            continue;
+        } else if (arg == "--record" && i + 1 < argc) {
+            client.recordPath = argv[++i];
+        } else if (arg == "--socket-buffer-kb" && i + 1 < argc) {
+            client.socketBuffer = atoi(argv[++i]) * 1024;
+        } else if (arg == "--frame-reads") {
+            client.frameReads = true;
+        } else if (arg == "--debug-kb-per-tick" && i + 1 < argc) {
+            client.debugBytesPerTick = atoi(argv[++i]) * 1024;
+        } else if (arg == "--async-debug") {
+            client.asyncDebug = true;
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    std::string host = args.size() < 1 ? "127.0.0.1" : args[0];
+    int port = args.size() < 2 ? 31001 : atoi(args[1].c_str());
+    std::string token = args.size() < 3 ? "0000000000000000" : args[2];
+    Runner(host, port, token, options, client).run();
     return 0;
 }
\ No newline at end of file
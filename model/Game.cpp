@@ -47,6 +47,38 @@ Game Game::readFrom(InputStream& stream) {
     return Game(myId, players, currentTick, units, loot, projectiles, zone, sounds);
 }
 
+// Read Game from input stream over an existing one, reusing the capacity of its lists
+void Game::readFrom(InputStream& stream, Game& value) {
+    value.myId = stream.readInt();
+    size_t playersSize = stream.readInt();
+    value.players.clear();
+    for (size_t playersIndex = 0; playersIndex < playersSize; playersIndex++) {
+        value.players.emplace_back(model::Player::readFrom(stream));
+    }
+    value.currentTick = stream.readInt();
+    size_t unitsSize = stream.readInt();
+    value.units.clear();
+    for (size_t unitsIndex = 0; unitsIndex < unitsSize; unitsIndex++) {
+        value.units.emplace_back(model::Unit::readFrom(stream));
+    }
+    size_t lootSize = stream.readInt();
+    value.loot.clear();
+    for (size_t lootIndex = 0; lootIndex < lootSize; lootIndex++) {
+        value.loot.emplace_back(model::Loot::readFrom(stream));
+    }
+    size_t projectilesSize = stream.readInt();
+    value.projectiles.clear();
+    for (size_t projectilesIndex = 0; projectilesIndex < projectilesSize; projectilesIndex++) {
+        value.projectiles.emplace_back(model::Projectile::readFrom(stream));
+    }
+    value.zone = model::Zone::readFrom(stream);
+    size_t soundsSize = stream.readInt();
+    value.sounds.clear();
+    for (size_t soundsIndex = 0; soundsIndex < soundsSize; soundsIndex++) {
+        value.sounds.emplace_back(model::Sound::readFrom(stream));
+    }
+}
+
 // Write Game to output stream
 void Game::writeTo(OutputStream& stream) const {
     stream.write(myId);
@@ -46,6 +46,9 @@ public:
     // Read Game from input stream
     static Game readFrom(InputStream& stream);
 
+    // Read Game from input stream over an existing one, reusing the capacity of its lists
+    static void readFrom(InputStream& stream, Game& value);
+
     // Write Game to output stream
     void writeTo(OutputStream& stream) const;
 
@@ -0,0 +1,72 @@
+#ifndef __MODEL_INLINE_VECTOR_HPP__
+#define __MODEL_INLINE_VECTOR_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace model {
+
+// Vector with fixed capacity stored inline, copying it never touches the heap
+template<typename T, size_t N>
+class InlineVector {
+public:
+    InlineVector() : count(0) {}
+
+    InlineVector(std::initializer_list<T> values) : count(0) {
+        for (auto& value : values) {
+            emplace_back(value);
+        }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    static constexpr size_t capacity() { return N; }
+
+    void reserve(size_t size) {
+        if (size > N) {
+            throw std::length_error("InlineVector capacity exceeded");
+        }
+    }
+
+    void clear() { count = 0; }
+
+    void resize(size_t size) {
+        reserve(size);
+        std::fill(items + std::min(size, count), items + size, T());
+        count = size;
+    }
+
+    void emplace_back(const T& value) {
+        if (count == N) {
+            throw std::length_error("InlineVector capacity exceeded");
+        }
+        items[count++] = value;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+
+    T& operator[](size_t index) { return items[index]; }
+    const T& operator[](size_t index) const { return items[index]; }
+
+    T* data() { return items; }
+    const T* data() const { return items; }
+
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+    bool operator==(const InlineVector& other) const {
+        return count == other.count && std::equal(begin(), end(), other.begin());
+    }
+
+private:
+    T items[N] = {};
+    size_t count;
+};
+
+}
+
+#endif
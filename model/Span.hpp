@@ -0,0 +1,45 @@
+#ifndef __MODEL_SPAN_HPP__
+#define __MODEL_SPAN_HPP__
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace model {
+
+// Non-owning view of values stored back to back. A span made from a braced list
+// is only valid until the end of the full expression, which is enough for arguments.
+template<typename T>
+class Span {
+public:
+    typedef std::remove_const_t<T> Value;
+
+    Span() : items(nullptr), count(0) {}
+    Span(T* items, size_t count) : items(items), count(count) {}
+    Span(std::initializer_list<Value> values) : count(values.size()) {
+        items = values.begin();
+    }
+
+    // Any container with data() and size(), like std::vector or InlineVector
+    template<typename Container, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Container>, Span>>,
+        typename = decltype(std::declval<Container&>().data())>
+    Span(Container&& container) : items(container.data()), count(container.size()) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T& operator[](size_t index) const { return items[index]; }
+
+    T* data() const { return items; }
+    T* begin() const { return items; }
+    T* end() const { return items + count; }
+
+private:
+    T* items;
+    size_t count;
+};
+
+}
+
+#endif
@@ -5,7 +5,7 @@
 
 namespace model {
 
-Unit::Unit(int id, int playerId, double health, double shield, int extraLives, model::Vec2 position, std::optional<double> remainingSpawnTime, model::Vec2 velocity, model::Vec2 direction, double aim, std::optional<model::Action> action, int healthRegenerationStartTick, std::optional<int> weapon, int nextShotTick, std::vector<int> ammo, int shieldPotions) : id(id), playerId(playerId), health(health), shield(shield), extraLives(extraLives), position(position), remainingSpawnTime(remainingSpawnTime), velocity(velocity), direction(direction), aim(aim), action(action), healthRegenerationStartTick(healthRegenerationStartTick), weapon(weapon), nextShotTick(nextShotTick), ammo(ammo), shieldPotions(shieldPotions) { }
+Unit::Unit(int id, int playerId, double health, double shield, int extraLives, model::Vec2 position, std::optional<double> remainingSpawnTime, model::Vec2 velocity, model::Vec2 direction, double aim, std::optional<model::Action> action, int healthRegenerationStartTick, std::optional<int> weapon, int nextShotTick, model::AmmoList ammo, int shieldPotions) : id(id), playerId(playerId), health(health), shield(shield), extraLives(extraLives), position(position), remainingSpawnTime(remainingSpawnTime), velocity(velocity), direction(direction), aim(aim), action(action), healthRegenerationStartTick(healthRegenerationStartTick), weapon(weapon), nextShotTick(nextShotTick), ammo(ammo), shieldPotions(shieldPotions) { }
     // Read Unit from input stream
     Unit Unit::readFrom(InputStream& stream) {
         int id = stream.readInt();
@@ -34,13 +34,9 @@ Unit::Unit(int id, int playerId, double health, double shield, int extraLives, m
             weapon.emplace(weaponValue);
         }
         int nextShotTick = stream.readInt();
-        std::vector<int> ammo = std::vector<int>();
-        size_t ammoSize = stream.readInt();
-        ammo.reserve(ammoSize);
-        for (size_t ammoIndex = 0; ammoIndex < ammoSize; ammoIndex++) {
-            int ammoElement = stream.readInt();
-            ammo.emplace_back(ammoElement);
-        }
+        model::AmmoList ammo;
+        ammo.resize(stream.readInt());
+        stream.readArray(ammo.data(), ammo.size());
         int shieldPotions = stream.readInt();
         return Unit(id, playerId, health, shield, extraLives, position, remainingSpawnTime, velocity, direction, aim, action, healthRegenerationStartTick, weapon, nextShotTick, ammo, shieldPotions);
     }
@@ -80,9 +76,7 @@ Unit::Unit(int id, int playerId, double health, double shield, int extraLives, m
         }
         stream.write(nextShotTick);
         stream.write((int)(ammo.size()));
-        for (const int& ammoElement : ammo) {
-            stream.write(ammoElement);
-        }
+        stream.writeArray(ammo.data(), ammo.size());
         stream.write(shieldPotions);
     }
 
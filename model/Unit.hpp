@@ -6,6 +6,7 @@
 #include "model/ActionType.hpp"
 #include "model/Vec2.hpp"
 #include "model/Constants.hpp"
+#include "model/InlineVector.hpp"
 #include "DebugInterface.hpp"
 #include <optional>
 #include <sstream>
@@ -15,6 +16,10 @@
 
 namespace model {
 
+// Upper bound on weapon types, ammo of a unit is kept inline
+const size_t MAX_WEAPON_TYPES = 8;
+typedef InlineVector<int, MAX_WEAPON_TYPES> AmmoList;
+
 // A unit
 class Unit {
 public:
@@ -47,7 +52,7 @@ public:
     // Next tick when unit can shoot again (can be less than current game tick)
     int nextShotTick;
     // List of ammo in unit's inventory for every weapon type
-    std::vector<int> ammo;
+    model::AmmoList ammo;
     // Number of shield potions in inventory
     int shieldPotions;
 
@@ -62,7 +67,7 @@ public:
 
     model::Vec2 next_position;
 
-    Unit(int id, int playerId, double health, double shield, int extraLives, model::Vec2 position, std::optional<double> remainingSpawnTime, model::Vec2 velocity, model::Vec2 direction, double aim, std::optional<model::Action> action, int healthRegenerationStartTick, std::optional<int> weapon, int nextShotTick, std::vector<int> ammo, int shieldPotions);
+    Unit(int id, int playerId, double health, double shield, int extraLives, model::Vec2 position, std::optional<double> remainingSpawnTime, model::Vec2 velocity, model::Vec2 direction, double aim, std::optional<model::Action> action, int healthRegenerationStartTick, std::optional<int> weapon, int nextShotTick, model::AmmoList ammo, int shieldPotions);
 
     // Read Unit from input stream
     static Unit readFrom(InputStream& stream);
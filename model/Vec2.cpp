@@ -1,24 +1,24 @@
 #include "Vec2.hpp"
 
 namespace model {
-    Vec2::Vec2() : x(0), y(0) { }
-    Vec2::Vec2(double x, double y) : x(x), y(y) { }
-
     // Read Vec2 from input stream
-    Vec2 Vec2::readFrom(InputStream& stream) {
-        double x = stream.readDouble();
-        double y = stream.readDouble();
-        return Vec2(x, y);
+    template<typename T>
+    Vec2T<T> Vec2T<T>::readFrom(InputStream& stream) {
+        double xy[2];
+        stream.readArray(xy, 2);
+        return Vec2T(xy[0], xy[1]);
     }
 
     // Write Vec2 to output stream
-    void Vec2::writeTo(OutputStream& stream) const {
-        stream.write(x);
-        stream.write(y);
+    template<typename T>
+    void Vec2T<T>::writeTo(OutputStream& stream) const {
+        double xy[2] = { x, y };
+        stream.writeArray(xy, 2);
     }
 
     // Get string representation of Vec2
-    std::string Vec2::toString() const {
+    template<typename T>
+    std::string Vec2T<T>::toString() const {
         std::stringstream ss;
         ss << "Vec2 { ";
         ss << "x: ";
@@ -30,24 +30,29 @@ namespace model {
         return ss.str();
     }
 
-    double Vec2::distTo(const Vec2& vec) const {
+    template<typename T>
+    T Vec2T<T>::distTo(const Vec2T& vec) const {
         return sqrt((x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y));
     }
 
-    double Vec2::distToSquared(const Vec2& vec) const {
+    template<typename T>
+    T Vec2T<T>::distToSquared(const Vec2T& vec) const {
         return (x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y);
     }
 
-    double Vec2::len() const {
+    template<typename T>
+    T Vec2T<T>::len() const {
         return sqrt(x * x + y * y);
     }
 
-    bool Vec2::isEmpty() {
+    template<typename T>
+    bool Vec2T<T>::isEmpty() {
         return x * x + y * y < 1e-9;
     }
 
-    Vec2& Vec2::norm() {
-        double l = len();
+    template<typename T>
+    Vec2T<T>& Vec2T<T>::norm() {
+        T l = len();
 
         if (l < 1e-8) {
             return *this;
@@ -59,37 +64,45 @@ namespace model {
         return *this;
     }
 
-    Vec2& Vec2::rotate(const double angle) {
-        double new_x = x * cos(angle) - y * sin(angle);
-        double new_y = x * sin(angle) + y * cos(angle);
+    template<typename T>
+    Vec2T<T>& Vec2T<T>::rotate(const T angle) {
+        T new_x = x * cos(angle) - y * sin(angle);
+        T new_y = x * sin(angle) + y * cos(angle);
         x = new_x;
         y = new_y;
 
         return *this;
     }
 
-    Vec2& Vec2::mul(const double& scalar) {
+    template<typename T>
+    Vec2T<T>& Vec2T<T>::mul(const T& scalar) {
         x *= scalar;
         y *= scalar;
 
         return *this;
     }
 
-    Vec2& Vec2::div(const double& scalar) {
+    template<typename T>
+    Vec2T<T>& Vec2T<T>::div(const T& scalar) {
         x /= scalar;
         y /= scalar;
 
         return *this;
     }
 
-    Vec2& Vec2::add(const Vec2& vec) {
+    template<typename T>
+    Vec2T<T>& Vec2T<T>::add(const Vec2T& vec) {
         x += vec.x;
         y += vec.y;
 
         return *this;
     }
 
-    Vec2 Vec2::clone() const {
+    template<typename T>
+    Vec2T<T> Vec2T<T>::clone() const {
         return {x, y};
     }
+
+    template class Vec2T<double>;
+    template class Vec2T<float>;
 }
\ No newline at end of file
@@ -8,20 +8,25 @@
 
 namespace model {
 
-// 2 dimensional vector.
-class Vec2 {
+// 2 dimensional vector. The game talks in double precision, the simulator kernels
+// can also run in float.
+template<typename T>
+class Vec2T {
 public:
     // `x` coordinate of the vector
-    double x;
+    T x;
     // `y` coordinate of the vector
-    double y;
+    T y;
 
-    Vec2();
+    constexpr Vec2T() : x(0), y(0) { }
 
-    Vec2(double x, double y);
+    constexpr Vec2T(T x, T y) : x(x), y(y) { }
+
+    template<typename U>
+    explicit constexpr Vec2T(const Vec2T<U>& vec) : x(T(vec.x)), y(T(vec.y)) { }
 
     // Read Vec2 from input stream
-    static Vec2 readFrom(InputStream& stream);
+    static Vec2T readFrom(InputStream& stream);
 
     // Write Vec2 to output stream
     void writeTo(OutputStream& stream) const;
@@ -29,50 +34,71 @@ public:
     // Get string representation of Vec2
     std::string toString() const;
 
-    double distTo(const Vec2& vec) const;
+    T distTo(const Vec2T& vec) const;
 
-    double distToSquared(const Vec2& vec) const;
+    T distToSquared(const Vec2T& vec) const;
 
-    double len() const;
+    T len() const;
 
     bool isEmpty();
 
-    Vec2& norm();
-    Vec2& mul(const double& scalar);
-    Vec2& div(const double& scalar);
-    Vec2& add(const Vec2& vec);
-    Vec2 clone() const;
+    Vec2T& norm();
+    Vec2T& mul(const T& scalar);
+    Vec2T& div(const T& scalar);
+    Vec2T& add(const Vec2T& vec);
+    Vec2T clone() const;
 
-    double dot(const Vec2& vec) const {
+    T dot(const Vec2T& vec) const {
         return x * vec.x + y * vec.y;
     }
 
-    double cross(const Vec2& vec) const {
+    T cross(const Vec2T& vec) const {
         return x * vec.y - y * vec.x;
     }
 
-    Vec2& rotate(const double angle);
+    Vec2T& rotate(const T angle);
+
+    // Rotate by the angle of a unit vector, like an entry of a DirectionFan
+    Vec2T& rotate(const Vec2T& turn) {
+        T new_x = x * turn.x - y * turn.y;
+        T new_y = x * turn.y + y * turn.x;
+        x = new_x;
+        y = new_y;
+
+        return *this;
+    }
 
-    Vec2& operator +=(const Vec2& vec) {
+    Vec2T rotated(const Vec2T& turn) const {
+        return Vec2T(x * turn.x - y * turn.y, x * turn.y + y * turn.x);
+    }
+
+    Vec2T& operator +=(const Vec2T& vec) {
         x += vec.x;
         y += vec.y;
 
         return *this;
     }
 
-    Vec2 operator +(const Vec2& vec) const {
-        return Vec2(x + vec.x, y + vec.y);
+    Vec2T operator +(const Vec2T& vec) const {
+        return Vec2T(x + vec.x, y + vec.y);
     }
 
-    Vec2 operator -(const Vec2& vec) const {
-        return Vec2(x - vec.x, y - vec.y);
+    Vec2T operator -(const Vec2T& vec) const {
+        return Vec2T(x - vec.x, y - vec.y);
     }
 
-    Vec2 operator *(const double& scalar) const {
-        return Vec2(scalar * x, scalar * y);
+    Vec2T operator *(const T& scalar) const {
+        return Vec2T(scalar * x, scalar * y);
     }
 };
 
+// Instantiated in Vec2.cpp
+extern template class Vec2T<double>;
+extern template class Vec2T<float>;
+
+typedef Vec2T<double> Vec2;
+typedef Vec2T<float> Vec2f;
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "BulletField.hpp"
+#include <algorithm>
+
+template<typename T>
+void BulletFieldT<T>::build(const ProjectileBatch& bullets, const ObstacleGrid& obstacle_grid, int ticks, double delta_time) {
+    stride = (bullets.size() + ProjectileBatchT<T>::LANES - 1) / ProjectileBatchT<T>::LANES * ProjectileBatchT<T>::LANES;
+    frames.resize(ticks);
+    obstacle_hits.resize(ticks * stride);
+
+    // Only obstacles lying on some bullet's path within the horizon can stop a bullet
+    bullet_obstacles.clear();
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        double time = std::min(bullets.life[i], ticks * delta_time);
+        model::Vec2 from(bullets.x[i], bullets.y[i]);
+        model::Vec2 to = from + model::Vec2(bullets.vx[i], bullets.vy[i]) * time;
+        obstacle_grid.querySegment(from, to, 1e-6, true, near_obstacles);
+        bullet_obstacles.insert(bullet_obstacles.end(), near_obstacles.begin(), near_obstacles.end());
+    }
+    std::sort(bullet_obstacles.begin(), bullet_obstacles.end());
+    bullet_obstacles.erase(std::unique(bullet_obstacles.begin(), bullet_obstacles.end()), bullet_obstacles.end());
+
+    // First flight in the given order only finds the tick every projectile stops at
+    flight.clear();
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        flight.add(bullets, i);
+    }
+    stop_tick.assign(bullets.size(), ticks);
+    for (int tick = 0; tick < ticks; ++tick) {
+        step(flight, T(delta_time), obstacle_hits.data());
+        for (size_t i = 0; i < bullets.size(); ++i) {
+            if (!flight.alive(i) && stop_tick[i] == ticks) {
+                stop_tick[i] = tick;
+            }
+        }
+    }
+
+    order.resize(bullets.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return stop_tick[a] > stop_tick[b];
+    });
+    flight.clear();
+    for (size_t i : order) {
+        flight.add(bullets, i);
+    }
+
+    // Compacting drops exactly the tail of projectiles stopped on this tick
+    for (int tick = 0; tick < ticks; ++tick) {
+        frames[tick] = flight;
+        step(flight, T(delta_time), obstacle_hits.data() + tick * stride);
+        flight.compact();
+    }
+}
+
+template<typename T>
+void BulletFieldT<T>::step(ProjectileBatchT<T>& batch, T delta_time, T* hits) const {
+    std::fill(hits, hits + batch.paddedSize(), ProjectileBatchT<T>::NO_HIT);
+    model::Vec2T<T> bullets_min, bullets_max;
+    batch.sweptBounds(delta_time, bullets_min, bullets_max);
+    for (auto& obstacle : bullet_obstacles) {
+        if (obstacle->position.x + obstacle->radius < bullets_min.x || obstacle->position.x - obstacle->radius > bullets_max.x ||
+            obstacle->position.y + obstacle->radius < bullets_min.y || obstacle->position.y - obstacle->radius > bullets_max.y) {
+            continue;
+        }
+        batch.sweptCircleHits(model::Vec2T<T>(obstacle->position), {0, 0}, T(obstacle->radius_sq), delta_time, hits, true);
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!batch.alive(i)) {
+            continue;
+        }
+        if (hits[i] != ProjectileBatchT<T>::NO_HIT || batch.life[i] <= delta_time) {
+            batch.kill(i);
+            continue;
+        }
+        batch.x[i] += batch.vx[i] * delta_time;
+        batch.y[i] += batch.vy[i] * delta_time;
+        batch.life[i] -= delta_time;
+    }
+}
+
+template class BulletFieldT<double>;
+template class BulletFieldT<float>;
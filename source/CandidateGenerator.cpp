@@ -0,0 +1,262 @@
+#include "CandidateGenerator.hpp"
+#include "DirectionFan.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Unit vectors splitting the full turn into count steps
+std::vector<model::Vec2> makeFan(int count) {
+    std::vector<model::Vec2> fan;
+    for (int k = 0; k < count; ++k) {
+        fan.push_back(fan::unitVector(2 * M_PI * k / count));
+    }
+    return fan;
+}
+
+// Angle difference in [-pi, pi]
+double wrapAngle(double angle) {
+    return std::remainder(angle, 2 * M_PI);
+}
+
+}
+
+std::unique_ptr<CandidateGenerator> CandidateGenerator::create(const std::string& name, int budget) {
+    if (name == "fan") {
+        return std::make_unique<UniformFanGenerator>(budget);
+    }
+    if (name == "adaptive") {
+        return std::make_unique<AdaptiveGenerator>(budget);
+    }
+    if (name == "cem") {
+        return std::make_unique<CrossEntropyGenerator>(budget);
+    }
+    throw std::runtime_error("Unknown candidate generator " + name);
+}
+
+UniformFanGenerator::UniformFanGenerator(int budget) : CandidateGenerator(budget) {
+    makeFans(this->budget, velocity_fan, view_fan);
+}
+
+void UniformFanGenerator::makeFans(int budget, std::vector<model::Vec2>& velocity_fan, std::vector<model::Vec2>& view_fan) {
+    double scale = sqrt(budget / double(CandidateGenerator::DEFAULT_BUDGET));
+    int velocity_count = std::max(1, int(10 * scale + 0.5));
+    int view_count = std::max(1, int(6 * scale + 0.5));
+    while (velocity_count > 1 && 2 * velocity_count * view_count > budget) {
+        --velocity_count;
+    }
+    velocity_fan = makeFan(velocity_count);
+    view_fan = makeFan(view_count);
+}
+
+void UniformFanGenerator::append(const CandidateContext& context, const std::vector<model::Vec2>& velocity_fan, const std::vector<model::Vec2>& view_fan, std::vector<Plan>& plans) {
+    std::vector<model::Vec2> dirs;
+    for (auto& turn : view_fan) {
+        dirs.push_back(context.direction.rotated(turn));
+    }
+
+    for (auto& turn : velocity_fan) {
+        auto vel = context.velocity.rotated(turn) * context.speed;
+        for (auto& dir : dirs) {
+            plans.emplace_back(model::UnitOrder(vel, dir, std::nullopt));
+        }
+    }
+
+    for (auto& turn : velocity_fan) {
+        auto vel = context.velocity.rotated(turn) * context.speed;
+        for (auto& dir : dirs) {
+            plans.emplace_back(model::UnitOrder(vel, dir, model::Aim(false)));
+        }
+    }
+}
+
+void UniformFanGenerator::begin(const CandidateContext& context) {
+    this->context = context;
+    done = false;
+}
+
+bool UniformFanGenerator::next(std::vector<Plan>& plans) {
+    if (done) {
+        return false;
+    }
+    done = true;
+    append(context, velocity_fan, view_fan, plans);
+    return true;
+}
+
+AdaptiveGenerator::AdaptiveGenerator(int budget) : CandidateGenerator(budget) {
+    UniformFanGenerator::makeFans(this->budget / 2, velocity_fan, view_fan);
+}
+
+void AdaptiveGenerator::begin(const CandidateContext& context) {
+    this->context = context;
+    scored.clear();
+    velocity_step = 2 * M_PI / velocity_fan.size();
+    view_step = 2 * M_PI / view_fan.size();
+    spent = 0;
+}
+
+bool AdaptiveGenerator::next(std::vector<Plan>& plans) {
+    if (spent == 0) {
+        size_t first = plans.size();
+        UniformFanGenerator::append(context, velocity_fan, view_fan, plans);
+        spent += plans.size() - first;
+        return true;
+    }
+
+    // Best first, ties keep the order in which candidates were proposed
+    std::stable_sort(scored.begin(), scored.end(), [](const Scored& a, const Scored& b) {
+        return a.damage < b.damage;
+    });
+    velocity_step /= 2;
+    view_step /= 2;
+    model::Vec2 turns[4][2] = {
+        { fan::unitVector(velocity_step), model::Vec2(1, 0) },
+        { fan::unitVector(-velocity_step), model::Vec2(1, 0) },
+        { model::Vec2(1, 0), fan::unitVector(view_step) },
+        { model::Vec2(1, 0), fan::unitVector(-view_step) },
+    };
+
+    int parents = 0;
+    size_t first = plans.size();
+    for (auto& parent : scored) {
+        if (parents == PARENTS || spent + 4 > budget || parent.damage == NOT_EVALUATED) {
+            break;
+        }
+        if (parent.refined) {
+            continue;
+        }
+        parent.refined = true;
+        ++parents;
+        for (auto& turn : turns) {
+            Plan plan = parent.plan;
+            plan.first().targetVelocity.rotate(turn[0]);
+            plan.first().targetDirection.rotate(turn[1]);
+            plans.push_back(plan);
+        }
+        spent += 4;
+    }
+    return plans.size() > first;
+}
+
+void AdaptiveGenerator::feedback(const Plan* plans, const int* damages, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        scored.push_back({ plans[i], damages[i], false });
+    }
+}
+
+CrossEntropyGenerator::CrossEntropyGenerator(int budget) : CandidateGenerator(budget) {}
+
+void CrossEntropyGenerator::begin(const CandidateContext& context) {
+    this->context = context;
+    rng.seed(context.seed);
+    speed = context.velocity.len() * context.speed;
+    double sigma = M_PI;
+    for (int segment = 0; segment < SEGMENTS; ++segment) {
+        angle_mean[segment][0] = atan2(context.velocity.y, context.velocity.x);
+        angle_mean[segment][1] = atan2(context.direction.y, context.direction.x);
+        aim_probability[segment] = 0.5;
+    }
+    switch_mean = context.horizon / 2.0;
+    switch_sigma = context.horizon / 4.0;
+
+    if (context.warm_plan) {
+        const auto& segments = context.warm_plan->segments;
+        for (int segment = 0; segment < SEGMENTS; ++segment) {
+            const model::UnitOrder& order = segments[std::min<size_t>(segment, segments.size() - 1)].order;
+            angle_mean[segment][0] = atan2(order.targetVelocity.y, order.targetVelocity.x);
+            angle_mean[segment][1] = atan2(order.targetDirection.y, order.targetDirection.x);
+            aim_probability[segment] = order.action ? 0.8 : 0.2;
+        }
+        if (segments.size() > 1) {
+            switch_mean = segments[0].ticks;
+        }
+        sigma = M_PI / 2;
+    }
+    for (int segment = 0; segment < SEGMENTS; ++segment) {
+        angle_sigma[segment][0] = angle_sigma[segment][1] = sigma;
+    }
+    spent = 0;
+}
+
+bool CrossEntropyGenerator::next(std::vector<Plan>& plans) {
+    int round_size = std::max(1, budget / ROUNDS);
+    int count = std::min(round_size, budget - spent);
+    if (count <= 0) {
+        return false;
+    }
+
+    samples.clear();
+    for (int i = 0; i < count; ++i) {
+        Sample sample;
+        Plan plan;
+        for (int segment = 0; segment < SEGMENTS; ++segment) {
+            for (int k = 0; k < 2; ++k) {
+                sample.angles[segment][k] = std::normal_distribution<double>(angle_mean[segment][k], angle_sigma[segment][k])(rng);
+            }
+            sample.aim[segment] = std::bernoulli_distribution(aim_probability[segment])(rng);
+        }
+        double switch_tick = std::normal_distribution<double>(switch_mean, switch_sigma)(rng);
+        sample.switch_tick = std::clamp(int(switch_tick + 0.5), 1, std::max(1, context.horizon - 1));
+        samples.push_back(sample);
+
+        for (int segment = 0; segment < SEGMENTS; ++segment) {
+            plan.add(model::UnitOrder(
+                fan::unitVector(sample.angles[segment][0]) * speed,
+                fan::unitVector(sample.angles[segment][1]),
+                sample.aim[segment] ? std::optional<model::ActionOrder>(model::Aim(false)) : std::nullopt
+            ), segment == 0 ? sample.switch_tick : INT_MAX);
+        }
+        plans.push_back(plan);
+    }
+    spent += count;
+    return true;
+}
+
+void CrossEntropyGenerator::feedback(const Plan* /*plans*/, const int* damages, size_t count) {
+    std::vector<size_t> ranked;
+    for (size_t i = 0; i < count && i < samples.size(); ++i) {
+        if (damages[i] != NOT_EVALUATED) {
+            ranked.push_back(i);
+        }
+    }
+    if (ranked.empty()) {
+        return;
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [&](size_t a, size_t b) {
+        return damages[a] < damages[b];
+    });
+    size_t elite = std::clamp<size_t>(ranked.size() / 5, 1, ranked.size());
+
+    // Circular means of the angles, spreads measured around them
+    for (int segment = 0; segment < SEGMENTS; ++segment) {
+        for (int k = 0; k < 2; ++k) {
+            double x = 0, y = 0;
+            for (size_t e = 0; e < elite; ++e) {
+                x += cos(samples[ranked[e]].angles[segment][k]);
+                y += sin(samples[ranked[e]].angles[segment][k]);
+            }
+            double mean = atan2(y, x);
+            double var = 0;
+            for (size_t e = 0; e < elite; ++e) {
+                var += pow(wrapAngle(samples[ranked[e]].angles[segment][k] - mean), 2);
+            }
+            angle_mean[segment][k] = mean;
+            angle_sigma[segment][k] = std::max(MIN_SIGMA, sqrt(var / elite));
+        }
+        int aiming = 0;
+        for (size_t e = 0; e < elite; ++e) {
+            aiming += samples[ranked[e]].aim[segment];
+        }
+        aim_probability[segment] = std::clamp(double(aiming) / elite, 0.05, 0.95);
+    }
+
+    double switch_sum = 0, switch_sq = 0;
+    for (size_t e = 0; e < elite; ++e) {
+        switch_sum += samples[ranked[e]].switch_tick;
+        switch_sq += double(samples[ranked[e]].switch_tick) * samples[ranked[e]].switch_tick;
+    }
+    switch_mean = switch_sum / elite;
+    switch_sigma = std::max(1.0, sqrt(std::max(0.0, switch_sq / elite - switch_mean * switch_mean)));
+}
@@ -0,0 +1,59 @@
+#include "DangerMap.hpp"
+#include <algorithm>
+
+template<typename T>
+void DangerMap::build(
+        const BulletFieldT<T>& field,
+        const model::Zone& zone,
+        const model::Vec2& center,
+        double reach,
+        double cell_size,
+        double unit_radius,
+        double margin,
+        double delta_time) {
+    this->cell_size = cell_size;
+    this->margin = margin;
+    width = std::max(1, (int)std::ceil(2 * reach / cell_size));
+    origin = center - model::Vec2(width * cell_size / 2, width * cell_size / 2);
+    cells = width * width;
+    ticks = field.ticks();
+    marks.assign((size_t)ticks * cells, 0);
+
+    // Boxes around the path of every bullet over each tick, grown by everything that
+    // lets the unit touch it
+    double grow = unit_radius + margin + 1e-6;
+    for (int tick = 0; tick < ticks; ++tick) {
+        const ProjectileBatchT<T>& batch = field.frame(tick);
+        char* layer = &marks[(size_t)tick * cells];
+        for (size_t i = 0; i < batch.size(); ++i) {
+            double x0 = batch.x[i];
+            double y0 = batch.y[i];
+            double x1 = x0 + batch.vx[i] * delta_time;
+            double y1 = y0 + batch.vy[i] * delta_time;
+            int min_x = std::max(0, (int)std::floor((std::min(x0, x1) - grow - origin.x) / cell_size));
+            int min_y = std::max(0, (int)std::floor((std::min(y0, y1) - grow - origin.y) / cell_size));
+            int max_x = std::min(width - 1, (int)std::floor((std::max(x0, x1) + grow - origin.x) / cell_size));
+            int max_y = std::min(width - 1, (int)std::floor((std::max(y0, y1) + grow - origin.y) / cell_size));
+            for (int y = min_y; y <= max_y; ++y) {
+                for (int x = min_x; x <= max_x; ++x) {
+                    layer[y * width + x] = 1;
+                }
+            }
+        }
+    }
+
+    // The zone does not move within a rollout, a cell is in the damage ring when even
+    // its point nearest to the zone center is
+    zone_cells.assign(cells, 0);
+    for (int y = 0; y < width; ++y) {
+        for (int x = 0; x < width; ++x) {
+            model::Vec2 nearest(
+                std::clamp(zone.currentCenter.x, origin.x + x * cell_size, origin.x + (x + 1) * cell_size),
+                std::clamp(zone.currentCenter.y, origin.y + y * cell_size, origin.y + (y + 1) * cell_size));
+            zone_cells[y * width + x] = zone.currentCenter.distTo(nearest) + unit_radius >= zone.currentRadius;
+        }
+    }
+}
+
+template void DangerMap::build(const BulletFieldT<double>&, const model::Zone&, const model::Vec2&, double, double, double, double, double);
+template void DangerMap::build(const BulletFieldT<float>&, const model::Zone&, const model::Vec2&, double, double, double, double, double);
@@ -1,16 +1,91 @@
 #include "DebugInterface.hpp"
 #include "codegame/ClientMessage.hpp"
+#include <charconv>
+#include <chrono>
+#include <cstring>
 
-DebugInterface::DebugInterface(TcpStream* stream): stream(stream) {}
+// Tags written by writeClientMessage for DebugMessage, Add and the DebugData alternatives
+static const int DEBUG_MESSAGE_TAG = 0;
+static const int ADD_TAG = 0;
+static const int PLACED_TEXT_TAG = 0;
+static const int CIRCLE_TAG = 1;
+static const int RING_TAG = 3;
+static const int POLYGON_TAG = 7;
+static const int SEGMENT_TAG = 9;
+static const int POLY_LINE_TAG = 11;
 
-void DebugInterface::addPlacedText(model::Vec2 position, std::string text, model::Vec2 alignment, double size, debugging::Color color)
+DebugInterface::DebugInterface(TcpStream* stream, size_t bytesPerTick): stream(stream), bytesPerTick(bytesPerTick) {}
+
+DebugInterface::~DebugInterface()
+{
+    if (writer.joinable()) {
+        Record stop;
+        stop.kind = Record::STOP;
+        push(stop);
+        writer.join();
+    }
+}
+
+void DebugInterface::startWriter(size_t queueCapacity)
+{
+    if (queue) {
+        return;
+    }
+    queue = std::make_unique<SpscQueue<Record>>(queueCapacity);
+    writer = std::thread(&DebugInterface::writerLoop, this);
+}
+
+void DebugInterface::addPlacedText(model::Vec2 position, std::string_view text, model::Vec2 alignment, double size, debugging::Color color)
 {
-    add(debugging::DebugData(debugging::PlacedText(position, text, alignment, size, color)));
+    if (queue && text.size() <= Record::TEXT_CAPACITY) {
+        Record record;
+        record.kind = Record::ADD_PLACED_TEXT;
+        record.first = position;
+        record.second = alignment;
+        record.width = size;
+        record.color = color;
+        record.textLength = text.size();
+        memcpy(record.text, text.data(), text.size());
+        push(record);
+        return;
+    }
+    if (queue) {
+        add(debugging::DebugData(debugging::PlacedText(position, std::string(text), alignment, size, color)));
+        return;
+    }
+    encodePlacedText(position, text, alignment, size, color);
+}
+
+void DebugInterface::addPlacedNumber(model::Vec2 position, int value, model::Vec2 alignment, double size, debugging::Color color)
+{
+    char text[16];
+    char* end = std::to_chars(text, text + sizeof(text), value).ptr;
+    addPlacedText(position, std::string_view(text, end - text), alignment, size, color);
+}
+
+void DebugInterface::addPlacedNumber(model::Vec2 position, double value, int precision, model::Vec2 alignment, double size, debugging::Color color)
+{
+    char text[64];
+    std::to_chars_result result = std::to_chars(text, text + sizeof(text), value, std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        addPlacedText(position, std::to_string(value), alignment, size, color);
+        return;
+    }
+    addPlacedText(position, std::string_view(text, result.ptr - text), alignment, size, color);
 }
 
 void DebugInterface::addCircle(model::Vec2 position, double radius, debugging::Color color)
 {
-    add(debugging::DebugData(debugging::Circle(position, radius, color)));
+    if (queue) {
+        Record record;
+        record.kind = Record::ADD_CIRCLE;
+        record.first = position;
+        record.radius = radius;
+        record.color = color;
+        push(record);
+        return;
+    }
+    encodeCircle(position, radius, color);
 }
 
 void DebugInterface::addGradientCircle(model::Vec2 position, double radius, debugging::Color innerColor, debugging::Color outerColor)
@@ -20,7 +95,17 @@ void DebugInterface::addGradientCircle(model::Vec2 position, double radius, debu
 
 void DebugInterface::addRing(model::Vec2 position, double radius, double width, debugging::Color color)
 {
-    add(debugging::DebugData(debugging::Ring(position, radius, width, color)));
+    if (queue) {
+        Record record;
+        record.kind = Record::ADD_RING;
+        record.first = position;
+        record.radius = radius;
+        record.width = width;
+        record.color = color;
+        push(record);
+        return;
+    }
+    encodeRing(position, radius, width, color);
 }
 
 void DebugInterface::addPie(model::Vec2 position, double radius, double startAngle, double endAngle, debugging::Color color)
@@ -38,9 +123,13 @@ void DebugInterface::addRect(model::Vec2 bottomLeft, model::Vec2 size, debugging
     add(debugging::DebugData(debugging::Rect(bottomLeft, size, color)));
 }
 
-void DebugInterface::addPolygon(std::vector<model::Vec2> vertices, debugging::Color color)
+void DebugInterface::addPolygon(model::Span<const model::Vec2> vertices, debugging::Color color)
 {
-    add(debugging::DebugData(debugging::Polygon(vertices, color)));
+    if (queue) {
+        add(debugging::DebugData(debugging::Polygon(std::vector<model::Vec2>(vertices.begin(), vertices.end()), color)));
+        return;
+    }
+    encodePolygon(vertices, color);
 }
 
 void DebugInterface::addGradientPolygon(std::vector<debugging::ColoredVertex> vertices)
@@ -50,7 +139,17 @@ void DebugInterface::addGradientPolygon(std::vector<debugging::ColoredVertex> ve
 
 void DebugInterface::addSegment(model::Vec2 firstEnd, model::Vec2 secondEnd, double width, debugging::Color color)
 {
-    add(debugging::DebugData(debugging::Segment(firstEnd, secondEnd, width, color)));
+    if (queue) {
+        Record record;
+        record.kind = Record::ADD_SEGMENT;
+        record.first = firstEnd;
+        record.second = secondEnd;
+        record.width = width;
+        record.color = color;
+        push(record);
+        return;
+    }
+    encodeSegment(firstEnd, secondEnd, width, color);
 }
 
 void DebugInterface::addGradientSegment(model::Vec2 firstEnd, debugging::Color firstColor, model::Vec2 secondEnd, debugging::Color secondColor, double width)
@@ -58,9 +157,23 @@ void DebugInterface::addGradientSegment(model::Vec2 firstEnd, debugging::Color f
     add(debugging::DebugData(debugging::GradientSegment(firstEnd, firstColor, secondEnd, secondColor, width)));
 }
 
-void DebugInterface::addPolyLine(std::vector<model::Vec2> vertices, double width, debugging::Color color)
+void DebugInterface::addPolyLine(model::Span<const model::Vec2> vertices, double width, debugging::Color color)
 {
-    add(debugging::DebugData(debugging::PolyLine(vertices, width, color)));
+    if (queue && vertices.size() == 2) {
+        Record record;
+        record.kind = Record::ADD_POLY_LINE;
+        record.first = vertices[0];
+        record.second = vertices[1];
+        record.width = width;
+        record.color = color;
+        push(record);
+        return;
+    }
+    if (queue) {
+        add(debugging::DebugData(debugging::PolyLine(std::vector<model::Vec2>(vertices.begin(), vertices.end()), width, color)));
+        return;
+    }
+    encodePolyLine(vertices, width, color);
 }
 
 void DebugInterface::addGradientPolyLine(std::vector<debugging::ColoredVertex> vertices, double width)
@@ -85,18 +198,195 @@ void DebugInterface::setAutoFlush(bool enable)
 
 void DebugInterface::flush()
 {
-    send(debugging::DebugCommand(debugging::Flush()));
+    if (queue) {
+        Record record;
+        record.kind = Record::FLUSH;
+        push(record);
+        return;
+    }
+    encode(debugging::DebugCommand(debugging::Flush()));
+    writeBatch();
 }
 
 void DebugInterface::send(debugging::DebugCommand command)
 {
+    if (queue) {
+        Record record;
+        record.kind = Record::COMMAND;
+        record.command = new debugging::DebugCommand(std::move(command));
+        push(record);
+        return;
+    }
+    encode(command);
+}
+
+void DebugInterface::encode(const debugging::DebugCommand& command)
+{
+    size_t batchSize = batch.size();
     codegame::ClientMessage message = codegame::DebugMessage(command);
-    codegame::writeClientMessage(message, *stream);
+    codegame::writeClientMessage(message, batch);
+    if (bytesPerTick > 0 && batch.size() > bytesPerTick && std::holds_alternative<debugging::Add>(command)) {
+        batch.truncate(batchSize);
+        ++dropped;
+    }
+}
+
+size_t DebugInterface::beginAdd(int dataTag)
+{
+    size_t batchSize = batch.size();
+    batch.write(DEBUG_MESSAGE_TAG);
+    batch.write(ADD_TAG);
+    batch.write(dataTag);
+    return batchSize;
+}
+
+void DebugInterface::endAdd(size_t batchSize)
+{
+    if (bytesPerTick > 0 && batch.size() > bytesPerTick) {
+        batch.truncate(batchSize);
+        ++dropped;
+    }
+}
+
+void DebugInterface::encodeCircle(model::Vec2 position, double radius, const debugging::Color& color)
+{
+    size_t batchSize = beginAdd(CIRCLE_TAG);
+    debugging::Circle(position, radius, color).writeTo(batch);
+    endAdd(batchSize);
+}
+
+void DebugInterface::encodeRing(model::Vec2 position, double radius, double width, const debugging::Color& color)
+{
+    size_t batchSize = beginAdd(RING_TAG);
+    debugging::Ring(position, radius, width, color).writeTo(batch);
+    endAdd(batchSize);
+}
+
+void DebugInterface::encodeSegment(model::Vec2 firstEnd, model::Vec2 secondEnd, double width, const debugging::Color& color)
+{
+    size_t batchSize = beginAdd(SEGMENT_TAG);
+    debugging::Segment(firstEnd, secondEnd, width, color).writeTo(batch);
+    endAdd(batchSize);
+}
+
+void DebugInterface::encodePolygon(model::Span<const model::Vec2> vertices, const debugging::Color& color)
+{
+    size_t batchSize = beginAdd(POLYGON_TAG);
+    debugging::Polygon::writeTo(batch, vertices, color);
+    endAdd(batchSize);
+}
+
+void DebugInterface::encodePolyLine(model::Span<const model::Vec2> vertices, double width, const debugging::Color& color)
+{
+    size_t batchSize = beginAdd(POLY_LINE_TAG);
+    debugging::PolyLine::writeTo(batch, vertices, width, color);
+    endAdd(batchSize);
+}
+
+void DebugInterface::encodePlacedText(model::Vec2 position, std::string_view text, model::Vec2 alignment, double size, const debugging::Color& color)
+{
+    size_t batchSize = beginAdd(PLACED_TEXT_TAG);
+    debugging::PlacedText::writeTo(batch, position, text, alignment, size, color);
+    endAdd(batchSize);
+}
+
+void DebugInterface::sendPending()
+{
+    if (queue) {
+        Record record;
+        record.kind = Record::SEND_PENDING;
+        push(record);
+        while (processedRecords.load(std::memory_order_acquire) < pushedRecords) {
+            if (writerSleeping.load()) {
+                writerWake.notify_one();
+            }
+            std::this_thread::yield();
+        }
+        return;
+    }
+    writeBatch();
+}
+
+void DebugInterface::push(const Record& record)
+{
+    while (!queue->push(record)) {
+        writerWake.notify_one();
+        std::this_thread::yield();
+    }
+    ++pushedRecords;
+    if (writerSleeping.load()) {
+        writerWake.notify_one();
+    }
+}
+
+void DebugInterface::process(const Record& record)
+{
+    switch (record.kind) {
+    case Record::ADD_CIRCLE:
+        encodeCircle(record.first, record.radius, record.color);
+        break;
+    case Record::ADD_RING:
+        encodeRing(record.first, record.radius, record.width, record.color);
+        break;
+    case Record::ADD_SEGMENT:
+        encodeSegment(record.first, record.second, record.width, record.color);
+        break;
+    case Record::ADD_POLY_LINE:
+        encodePolyLine({ record.first, record.second }, record.width, record.color);
+        break;
+    case Record::ADD_PLACED_TEXT:
+        encodePlacedText(record.first, std::string_view(record.text, record.textLength), record.second, record.width, record.color);
+        break;
+    case Record::COMMAND:
+        encode(*record.command);
+        delete record.command;
+        break;
+    case Record::FLUSH:
+        encode(debugging::Flush());
+        writeBatch();
+        break;
+    case Record::SEND_PENDING:
+    case Record::STOP:
+        writeBatch();
+        break;
+    }
+}
+
+void DebugInterface::writerLoop()
+{
+    Record record;
+    while (true) {
+        if (queue->pop(record)) {
+            process(record);
+            processedRecords.fetch_add(1, std::memory_order_release);
+            if (record.kind == Record::STOP) {
+                return;
+            }
+            continue;
+        }
+        // A missed wake up only costs the timeout
+        std::unique_lock<std::mutex> lock(writerMutex);
+        writerSleeping = true;
+        if (queue->empty()) {
+            writerWake.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        writerSleeping = false;
+    }
+}
+
+void DebugInterface::writeBatch()
+{
+    if (batch.size() == 0) {
+        return;
+    }
+    stream->writeBytes(batch.data(), batch.size());
     stream->flush();
+    batch.clear();
 }
 
 debugging::DebugState DebugInterface::getState()
 {
+    sendPending();
     codegame::ClientMessage message = codegame::RequestDebugState();
     codegame::writeClientMessage(message, *stream);
     stream->flush();
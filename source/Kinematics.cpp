@@ -0,0 +1,37 @@
+#include "Kinematics.hpp"
+#include <cmath>
+
+void KinematicsTable::build(const model::Constants& constants, double delta_time) {
+    double to_radians_per_tick = delta_time * M_PI / 180;
+    auto make = [&](double aim_time, double speed_modifier, double aim_rotation_speed) {
+        WeaponKinematics kinematics;
+        kinematics.aim_step = aim_time > 0 ? delta_time / aim_time : 0;
+        kinematics.speed_slope = 1 - speed_modifier;
+        kinematics.rotation_step = constants.rotationSpeed * to_radians_per_tick;
+        kinematics.rotation_slope = (constants.rotationSpeed - aim_rotation_speed) * to_radians_per_tick;
+        double aimed_step = kinematics.rotation_step - kinematics.rotation_slope;
+        kinematics.idle_cos = cos(kinematics.rotation_step);
+        kinematics.idle_sin = sin(kinematics.rotation_step);
+        kinematics.aimed_cos = cos(aimed_step);
+        kinematics.aimed_sin = sin(aimed_step);
+        kinematics.aim_step_cos = cos(kinematics.rotation_slope * kinematics.aim_step);
+        kinematics.aim_step_sin = sin(kinematics.rotation_slope * kinematics.aim_step);
+        return kinematics;
+    };
+
+    weapons.clear();
+    for (auto& weapon : constants.weapons) {
+        weapons.push_back(make(weapon.aimTime, weapon.aimMovementSpeedModifier, weapon.aimRotationSpeed));
+    }
+    // Without a weapon aim does not change and rotation slows down to zero
+    weapons.push_back(make(0, 1, 0));
+
+    double offset = (constants.maxUnitForwardSpeed - constants.maxUnitBackwardSpeed) / 2;
+    double radius = (constants.maxUnitForwardSpeed + constants.maxUnitBackwardSpeed) / 2;
+    offset_ratio = offset / radius;
+    len_base = offset * offset + radius * radius;
+    len_cos = 2 * offset * radius;
+
+    max_velocity_shift = constants.unitAcceleration * delta_time;
+    max_velocity_shift_sq = max_velocity_shift * max_velocity_shift;
+}
@@ -1,30 +1,55 @@
 #include "MyStrategy.hpp"
+#include "DirectionFan.hpp"
+#include <atomic>
 #include <exception>
 #include <variant>
 #include <chrono>
 
 const int UNIT_TTL = 20;
 const int LOOT_TTL = 300;
+// Distance between the predicted and the actual position at which a cached plan is dropped
+const double PLAN_DRIFT = 0.1;
+const double DANGER_CELL = 1.0;
 model::Constants* MyStrategy::constants_;
 
 model::Constants* MyStrategy::getConstants() {
     return constants_;
 }
 
-MyStrategy::MyStrategy(const model::Constants &consts) : constants(consts), simulator(consts) {
+MyStrategy::MyStrategy(const model::Constants &consts, const StrategyOptions& opts) : constants(consts), simulator(consts), options(opts) {
     MyStrategy::constants_ = &constants;
     delta_time = 1.0 / constants.ticksPerSecond;
-    simulator.delta_time = delta_time;
+    simulator.setDeltaTime(delta_time);
     for (auto& obstacle: constants.obstacles) {
         obstacle.radius_sq = sqr(obstacle.radius);
     }
+    obstacle_grid.build(constants.obstacles, ObstacleGrid::DEFAULT_CELL);
+    simulator.obstacle_grid = &obstacle_grid;
+
+    size_t threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    pool = std::make_unique<ThreadPool>(threads);
+    worker_simulators.assign(pool->size(), simulator);
+    generator = CandidateGenerator::create(options.candidate_generator, options.candidate_budget);
+    for (size_t worker = 0; worker < pool->size(); ++worker) {
+        worker_generators.push_back(CandidateGenerator::create(options.candidate_generator, options.candidate_budget));
+    }
+
+    profiler = std::make_unique<Profiler>(pool->size());
+    if (!options.profile_path.empty()) {
+        profiler->stream(options.profile_path);
+    }
 }
 
 model::Order MyStrategy::getOrder(model::Game &game, DebugInterface *dbgInterface) {
-    auto t_start = std::chrono::system_clock::now();
-    default_dir.rotate(M_PI / 2000);
+    auto t_start = Profiler::Clock::now();
+    profiler->beginTick(game.currentTick);
+    auto deadline = tickDeadline(game.zone);
+    default_dir.rotate(DEFAULT_DIR_STEP);
 
     simulator.started_tick = game.currentTick;
+    for (auto& worker_simulator : worker_simulators) {
+        worker_simulator.started_tick = game.currentTick;
+    }
     debugInterface = dbgInterface;
     my_units.clear();
 
@@ -36,9 +61,9 @@ model::Order MyStrategy::getOrder(model::Game &game, DebugInterface *dbgInterfac
     std::unordered_map<int, model::UnitOrder> actions;
     for (auto &unit : game.units) {
         if (unit.playerId != game.myId) {
-            enemies.insert_or_assign(unit.id, unit);
-            enemies.at(unit.id).ttl = UNIT_TTL;
-            enemies.at(unit.id).unit_radius_sq = constants.unitRadius * constants.unitRadius;
+            model::Unit& enemy = enemies[enemies.assign(unit.id, unit)];
+            enemy.ttl = UNIT_TTL;
+            enemy.unit_radius_sq = constants.unitRadius * constants.unitRadius;
         }
     }
 
@@ -46,22 +71,24 @@ model::Order MyStrategy::getOrder(model::Game &game, DebugInterface *dbgInterfac
         if (constants.sounds[sound.typeIndex].name != "Steps") continue;
         int fake_id = -(rand() % 1000000);
         model::Unit fake_enemy(fake_id, -1, 100, 50, 0, sound.position, 0, {0, 0}, {0, 0}, 0, {}, 0, {}, 0, {}, 0);
-        enemies.insert_or_assign(fake_enemy.id, fake_enemy);
-        enemies.at(fake_id).ttl = UNIT_TTL - 2;
-        enemies.at(fake_id).unit_radius_sq = constants.unitRadius * constants.unitRadius;
+        model::Unit& enemy = enemies[enemies.assign(fake_id, fake_enemy)];
+        enemy.ttl = UNIT_TTL - 2;
+        enemy.unit_radius_sq = constants.unitRadius * constants.unitRadius;
     }
 
     for (auto &projectile : game.projectiles) {
-        bullets.insert_or_assign(projectile.id, projectile);
+        bullets.assign(projectile.id, projectile);
     }
 
     for (auto &loot : game.loot) {
-        loots.insert_or_assign(loot.id, loot);
-        loots.at(loot.id).ttl = LOOT_TTL;
+        loots[loots.assign(loot.id, loot)].ttl = LOOT_TTL;
     }
 
     busy_loot.clear();
+    profiler->record(Profiler::INGESTION, t_start);
 
+    // Snapshot of our team first, so every unit plans against the same allies
+    std::vector<model::Unit*> team;
     int i = 0;
     for (model::Unit &myUnit : game.units) {
         if (myUnit.playerId != game.myId)
@@ -72,41 +99,37 @@ model::Order MyStrategy::getOrder(model::Game &game, DebugInterface *dbgInterfac
 
         if (!myUnit.remainingSpawnTime.has_value())
             my_units.emplace_back(&myUnit);
+        team.emplace_back(&myUnit);
+        ++i;
+    }
 
-        if (debugInterface) {
-            for (auto &[key, projectile] : bullets) {
-                if (projectile.intersectUnit(myUnit, constants)) {
+    if (debugInterface) {
+        for (auto myUnit : team) {
+            for (auto &projectile : bullets) {
+                if (projectile.intersectUnit(*myUnit, constants)) {
                     debugInterface->addPolyLine({projectile.position, projectile.position + projectile.velocity * projectile.lifeTime }, 0.1, debugging::Color(0, 0.3, 0.6, 1));
                 }
             }
         }
-
-        auto unitOrder = getUnitOrder(myUnit, game.zone);
-        actions.insert({ myUnit.id, unitOrder });
-        ++i;
     }
 
-    std::vector<model::Obstacle*> obstacles;
-    for (auto &obstacle : constants.obstacles) {
-        if (obstacle.canShootThrough) {
-            continue;
-        }
-        for (auto& myUnit : my_units) {
-            auto dist = myUnit->position.distTo(obstacle.position) - obstacle.radius;
-            if(2 * dist <= constants.viewDistance) {
-                obstacles.push_back(&obstacle);
-                break;
-            }
-        }
+    auto t_plan_start = Profiler::Clock::now();
+    planTeam(team, game.zone, deadline, actions);
+    profiler->record(Profiler::TEAM_PLAN, t_plan_start);
+    auto t_update_start = Profiler::Clock::now();
+    auto team_latency = std::chrono::duration_cast<std::chrono::microseconds>(t_update_start - t_plan_start).count();
+    ++planned_ticks;
+    total_team_latency += team_latency;
+    max_team_latency = std::max(max_team_latency, (long long)team_latency);
+    if (options.log_latency) {
+        std::clog << "Tick " << game.currentTick << " -- " << "Team decision " << team_latency << " us" << std::endl;
     }
 
-    std::vector<int> destroyed_ids;
-    for (auto& [key, bullet] : bullets) {
+    std::vector<const model::Obstacle*> obstacles;
+    bullets.eraseIf([&](model::Projectile& bullet) {
         bool destroyed = false;
+        obstacle_grid.querySegment(bullet.position, bullet.position + bullet.velocity * delta_time, 0, true, obstacles);
         for (auto& obstacle : obstacles) {
-            if ((bullet.position.distTo(obstacle->position) - obstacle->radius) / constants.weapons[bullet.weaponTypeIndex].projectileSpeed > delta_time) {
-                continue;
-            }
             if (bullet.hasHit(*obstacle)) {
                 destroyed = true;
                 break;
@@ -114,8 +137,7 @@ model::Order MyStrategy::getOrder(model::Game &game, DebugInterface *dbgInterfac
         }
 
         if (destroyed) {
-            destroyed_ids.emplace_back(key);
-            continue;
+            return true;
         }
 
         for (auto& unit : my_units) {
@@ -127,38 +149,21 @@ model::Order MyStrategy::getOrder(model::Game &game, DebugInterface *dbgInterfac
         bullet.position += bullet.velocity * delta_time;
         bullet.lifeTime -= delta_time;
 
-        if (destroyed || bullet.lifeTime <= 0) {
-            destroyed_ids.emplace_back(key);
-            continue;
-        }
-    }
-
-    for (auto& id: destroyed_ids) {
-        bullets.erase(id);
-    }
+        return destroyed || bullet.lifeTime <= 0;
+    });
 
-    destroyed_ids.clear();
-    for (auto& [key, enemy] : enemies) {
+    enemies.eraseIf([&](model::Unit& enemy) {
         enemy.ttl--;
         if (enemy.ttl == 0) {
-            destroyed_ids.emplace_back(key);
-            continue;
+            return true;
         }
         enemy.position += enemy.velocity * delta_time;
-    }
-
-    for (auto& id: destroyed_ids) {
-        enemies.erase(id);
-    }
-
-    destroyed_ids.clear();
+        return false;
+    });
 
-    for (auto& [key, loot] : loots) {
-        loot.ttl--;
-        if (loot.ttl == 0) {
-            destroyed_ids.emplace_back(key);
-        }
-    }
+    loots.eraseIf([](model::Loot& loot) {
+        return --loot.ttl == 0;
+    });
 
     for (auto& [unit_id, order] : actions) {
         if (!order.action || !std::holds_alternative<model::Pickup>(*order.action)) continue;
@@ -167,51 +172,145 @@ model::Order MyStrategy::getOrder(model::Game &game, DebugInterface *dbgInterfac
             if (unit->id == unit_id) myUnit = unit;
         }
         if (myUnit && !myUnit->action && myUnit->aim < 1e-9 && busy_loot.count(myUnit->id)) {
-            destroyed_ids.emplace_back(busy_loot.at(myUnit->id));
+            loots.erase(busy_loot.at(myUnit->id));
         }
     }
 
-    for (auto& id: destroyed_ids) {
-        if (loots.count(id)) loots.erase(id);
-    }
-
     if (debugInterface) {
-        for (auto &[key, enemy] : enemies) {
+        for (auto &enemy : enemies) {
             debugInterface->addRing(enemy.position, constants.unitRadius, 0.1, debugging::Color(1, 0, 0, 0.8));
-            debugInterface->addPlacedText(enemy.position, std::to_string(key), {0, -1}, 0.3, debugging::Color(0, 0, 0, 0.5));
+            debugInterface->addPlacedNumber(enemy.position, enemy.id, {0, -1}, 0.3, debugging::Color(0, 0, 0, 0.5));
         }
         debugInterface->flush();
     }
 
-    auto t_end = std::chrono::system_clock::now();
+    profiler->record(Profiler::WORLD_UPDATE, t_update_start);
+    auto collect_counters = [&](Simulator& sim) {
+        profiler->add(Profiler::ROLLOUTS, sim.rollouts);
+        profiler->add(Profiler::SIMULATED_BULLETS, sim.simulated_bullets);
+        profiler->add(Profiler::PLANNED_DAMAGE, sim.planned_damage);
+        profiler->add(Profiler::PLAN_CACHE_HITS, sim.plan_cache_hits);
+        profiler->add(Profiler::PRUNED_TICKS, sim.pruned_ticks);
+        skipped_candidates += sim.skipped_candidates;
+        sim.rollouts = sim.simulated_bullets = sim.planned_damage = sim.plan_cache_hits = sim.pruned_ticks = 0;
+        sim.skipped_candidates = 0;
+    };
+    collect_counters(simulator);
+    for (auto& sim : worker_simulators) {
+        collect_counters(sim);
+    }
 
-    elapsed_time += std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count();
-    // std::clog << "Elapsed time: " << std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count() << " ms" << std::endl;
+    profiler->record(Profiler::TICK, t_start);
+    spent_time_us += std::chrono::duration_cast<std::chrono::microseconds>(Profiler::Clock::now() - t_start).count();
 
     return model::Order(actions);
 }
 
-model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone& zone) {
+Deadline MyStrategy::tickDeadline(const model::Zone& zone) const {
+    if (options.tick_budget_ms <= 0) {
+        return Deadline();
+    }
+
+    // The game goes on at least until the zone collapses, spread what is left of the
+    // total budget evenly over the ticks until then
+    double remaining_ticks = std::max(constants.ticksPerSecond * 10, zone.currentRadius / constants.zoneSpeed * constants.ticksPerSecond);
+    double remaining_us = options.total_budget_s * 1e6 * (1 - options.budget_reserve) - spent_time_us;
+    double budget_us = std::min(options.tick_budget_ms * 1e3, std::max(0.0, remaining_us) / remaining_ticks);
+    return Deadline::in(std::chrono::microseconds((long long)budget_us));
+}
+
+void MyStrategy::planTeam(const std::vector<model::Unit*>& team, const model::Zone& zone, const Deadline& deadline, std::unordered_map<int, model::UnitOrder>& actions) {
+    for (auto it = plan_cache.begin(); it != plan_cache.end();) {
+        if (simulator.started_tick - it->second.tick >= simulator.simulated_ticks) {
+            it = plan_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Debug drawing is not thread safe, so visualized runs always plan serially
+    if (!options.parallel_units || debugInterface || team.size() < 2) {
+        for (size_t k = 0; k < team.size(); ++k) {
+            auto unit_deadline = deadline.share(team.size() - k);
+            std::optional<CachedPlan> dodge_plan;
+            actions.insert({ team[k]->id, getUnitOrder(*team[k], zone, simulator, *generator, busy_loot, unit_deadline, dodge_plan) });
+            rememberPlan(team[k]->id, dodge_plan);
+        }
+        return;
+    }
+
+    std::vector<std::optional<model::UnitOrder>> planned(team.size());
+    std::vector<std::optional<CachedPlan>> dodge_plans(team.size());
+    std::vector<LootReservations> reservations(team.size());
+    pool->parallelFor(team.size(), [&](size_t worker, size_t k) {
+        planned[k] = getUnitOrder(*team[k], zone, worker_simulators[worker], *worker_generators[worker], reservations[k], deadline, dodge_plans[k]);
+    });
+
+    // Every unit was planned as if it came first. Looting picks the nearest free loot, so a
+    // unit keeps its plan unless a unit before it already reserved the same loot; such a unit
+    // is planned again against the committed reservations, which reproduces the serial result.
+    for (size_t k = 0; k < team.size(); ++k) {
+        auto reserved = reservations[k].find(team[k]->id);
+        bool conflict = false;
+        if (reserved != reservations[k].end()) {
+            for (auto& [unit_id, loot_id] : busy_loot) {
+                conflict = conflict || loot_id == reserved->second;
+            }
+        }
+
+        if (conflict) {
+            planned[k] = getUnitOrder(*team[k], zone, simulator, *generator, busy_loot, deadline.share(team.size() - k), dodge_plans[k]);
+        } else if (reserved != reservations[k].end()) {
+            busy_loot.insert(*reserved);
+        }
+        actions.insert({ team[k]->id, *planned[k] });
+    }
+    // Stored only now, the workers above read plan_cache concurrently
+    for (size_t k = 0; k < team.size(); ++k) {
+        rememberPlan(team[k]->id, dodge_plans[k]);
+    }
+}
+
+void MyStrategy::rememberPlan(int unit_id, std::optional<CachedPlan>& plan) {
+    if (plan) {
+        plan_cache[unit_id] = std::move(*plan);
+    } else {
+        plan_cache.erase(unit_id);
+    }
+}
+
+std::optional<Plan> MyStrategy::cachedPlan(const model::Unit& myUnit) const {
+    auto cached = plan_cache.find(myUnit.id);
+    if (cached == plan_cache.end()) {
+        return std::nullopt;
+    }
+    int elapsed = simulator.started_tick - cached->second.tick;
+    if (elapsed <= 0 || elapsed > (int)cached->second.trajectory.size()) {
+        return std::nullopt;
+    }
+    if (cached->second.trajectory[elapsed - 1].distToSquared(myUnit.position) > sqr(PLAN_DRIFT)) {
+        return std::nullopt;
+    }
+    Plan plan = cached->second.plan;
+    plan.shift(elapsed);
+    return plan;
+}
+
+model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone& zone, Simulator& simulator, CandidateGenerator& generator, LootReservations& busy_loot, const Deadline& deadline, std::optional<CachedPlan>& dodge_plan) {
+    Profiler::Scope scope(*profiler, Profiler::UNIT_ORDER);
+    dodge_plan.reset();
     std::vector<model::UnitOrder> orders;
-    std::vector<const model::Obstacle*> obstacles;
 
     if (debugInterface) {
         myUnit.calcSpeedCircle(constants);
         myUnit.showSpeedCircle(debugInterface);
     }
 
-    for (auto &obstacle : constants.obstacles) {
-        auto dist = myUnit.position.distTo(obstacle.position) - obstacle.radius;
-        if(dist < constants.viewDistance) {
-            obstacles.push_back(&obstacle);
-        }
-    }
-
     model::Unit* nearest_enemy = nullptr;
     model::Unit* nearest_spawn_enemy = nullptr;
     double min_dist_to_enemy = 1e9;
     double min_dist_to_spawn_enemy = 1e9;
-    for (auto &[id, enemy] : enemies) {
+    for (auto &enemy : enemies) {
         auto distToEnemy = enemy.position.distToSquared(myUnit.position);
 
         if (enemy.remainingSpawnTime.has_value() || enemy.ttl < UNIT_TTL - 2) {
@@ -233,7 +332,7 @@ model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone
     bool is_spawn = myUnit.remainingSpawnTime.has_value();
 
     if (is_spawn) {
-        auto spawn_order = looting(myUnit, zone);
+        auto spawn_order = looting(myUnit, zone, busy_loot);
         if (spawn_order && myUnit.health >= constants.unitHealth) {
             return *spawn_order;
         }
@@ -247,7 +346,7 @@ model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone
 
     for (size_t ii = 0; ii < 1; ++ii) {
         if (nearest_enemy && ready_attack && 2 * min_dist_to_enemy < constants.viewDistance * constants.viewDistance) {
-            shooting(myUnit, nearest_enemy, obstacles, orders);
+            shooting(myUnit, nearest_enemy, orders, simulator);
             continue;
         }
 
@@ -261,7 +360,7 @@ model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone
         }
 
         auto healing_order = healing(myUnit);
-        auto loot_order = looting(myUnit, zone);
+        auto loot_order = looting(myUnit, zone, busy_loot);
 
         if (healing_order) {
             if (loot_order) {
@@ -284,7 +383,7 @@ model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone
             double dist_to_enemy = bullet_position.distTo(nearest_spawn_enemy->position) - constants.unitRadius;
             double time_to_hit = dist_to_enemy / constants.weapons[*myUnit.weapon].projectileSpeed;
             if (ready_attack && nearest_spawn_enemy->ttl == UNIT_TTL && nearest_spawn_enemy->remainingSpawnTime && time_to_hit >= *nearest_spawn_enemy->remainingSpawnTime) {
-                shooting(myUnit, nearest_spawn_enemy, obstacles, orders);
+                shooting(myUnit, nearest_spawn_enemy, orders, simulator);
                 continue;
             }
             orders.emplace_back(
@@ -314,17 +413,14 @@ model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone
     std::optional<model::Vec2> loot_pos;
     if(busy_loot.count(myUnit.id)) {
         int loot_id = busy_loot.at(myUnit.id);
-        for (auto& [id, loot]: loots) {
-            if (id == loot_id) {
-                loot_pos = loot.position;
-                break;
-            }
+        if (auto loot = loots.find(loot_id)) {
+            loot_pos = loot->position;
         }
     }
 
     for (auto& order: orders) {
         auto sim_unit(myUnit);
-        auto collision = simulator.SimulateMovement(sim_unit, order, obstacles, simulator.started_tick);
+        auto collision = simulator.SimulateMovement(sim_unit, order, simulator.started_tick);
         if (collision) {
             if (loot_pos && loot_pos->distToSquared(sim_unit.position) <= constants.unitRadius) continue;
             auto v = ((*collision)->position - sim_unit.position).norm();
@@ -336,82 +432,201 @@ model::UnitOrder MyStrategy::getUnitOrder(model::Unit& myUnit, const model::Zone
         }
     }
 
-    if (!bullets.empty()) {
-        auto initial_velocaity = myUnit.velocity.isEmpty() ? default_dir : myUnit.velocity;
-        auto vel = initial_velocaity;
-        for (size_t it1 = 0; it1 < 10; ++it1) {
-            auto dir = myUnit.direction;
-            for (size_t it2 = 0; it2 < 6; ++it2) {
-                orders.emplace_back(
-                    vel * constants.maxUnitForwardSpeed,
-                    dir,
-                    std::nullopt
-                );
-                dir.rotate(M_PI / 3);
-            }
-            vel.rotate(M_PI / 5);
-        }
-
-        vel = initial_velocaity;
-        for (size_t it1 = 0; it1 < 10; ++it1) {
-            auto dir = myUnit.direction;
-            for (size_t it2 = 0; it2 < 6; ++it2) {
-                orders.emplace_back(
-                    vel * constants.maxUnitForwardSpeed,
-                    dir,
-                    model::Aim(false)
-                );
-                dir.rotate(M_PI / 3);
-            }
-            vel.rotate(M_PI / 5);
+    // Strategic orders are held for the whole horizon, dodge plans may change course on the way
+    std::vector<Plan> plans;
+    for (auto& order : orders) {
+        plans.emplace_back(order);
+    }
+    size_t strategic_count = plans.size();
+    bool searching = !bullets.empty();
+    std::optional<Plan> warm_plan;
+    if (searching) {
+        warm_plan = cachedPlan(myUnit);
+        if (warm_plan) {
+            plans.push_back(*warm_plan);
         }
     }
 
     int min_damage = 1e9;
-    model::UnitOrder* best_order;
+    size_t best = 0;
 
-    std::vector<model::Projectile> sim_bullets;
-    for (const auto &b : bullets) {
-        if (b.second.position.distToSquared(myUnit.position) > sqr(b.second.lifeTime * constants.weapons[b.second.weaponTypeIndex].projectileSpeed))
+    ProjectileBatch sim_bullets;
+    for (const auto &bullet : bullets) {
+        if (bullet.position.distToSquared(myUnit.position) > sqr(bullet.lifeTime * constants.weapons[bullet.weaponTypeIndex].projectileSpeed))
+            continue;
+        if (bullet.shooterId == myUnit.id) continue;
+
+        sim_bullets.add(bullet, constants);
+    }
+    // Flight of the bullets and where it is dangerous, the same for every candidate
+    BulletField field;
+    BulletFieldT<float> field_float;
+    DangerMap danger;
+    double reach = constants.maxUnitForwardSpeed * simulator.simulated_ticks * delta_time + constants.unitRadius;
+    double margin = constants.maxUnitForwardSpeed * delta_time;
+    if (options.float_precision) {
+        field_float.build(sim_bullets, obstacle_grid, simulator.simulated_ticks, delta_time);
+        danger.build(field_float, zone, myUnit.position, reach, DANGER_CELL, constants.unitRadius, margin, delta_time);
+    } else {
+        field.build(sim_bullets, obstacle_grid, simulator.simulated_ticks, delta_time);
+        danger.build(field, zone, myUnit.position, reach, DANGER_CELL, constants.unitRadius, margin, delta_time);
+    }
+    auto rollout = [&](Simulator& sim, model::Unit& unit, const Plan& plan, int bound) {
+        if (options.float_precision) {
+            return sim.Simulate(unit, plan, field_float, zone, &danger, bound);
+        }
+        return sim.Simulate(unit, plan, field, zone, &danger, bound);
+    };
+
+    // The strategic orders and the cached plan make the first round, the dodge search only
+    // starts when the cached plan no longer avoids all damage.
+    // Best-first anytime evaluation: the most promising candidates of a round are simulated
+    // first and whatever is left when the deadline hits is skipped. The first one always runs.
+    // Rollouts stop once they can only end worse than the best damage seen so far; such a
+    // candidate reports a lower bound above it and can neither win nor tie.
+    std::vector<char> evaluated;
+    std::vector<int> damages;
+    std::vector<int> shot_credits;
+    std::vector<model::Vec2> final_positions;
+    std::atomic<int> bound(INT_MAX);
+    size_t round_begin = 0;
+    bool generating = false;
+    while (true) {
+        auto evaluation_order = prioritizeCandidates(myUnit, plans, std::max(strategic_count, round_begin), danger, simulator.simulated_ticks);
+        evaluated.resize(plans.size(), false);
+        damages.resize(plans.size(), CandidateGenerator::NOT_EVALUATED);
+        shot_credits.resize(plans.size(), 0);
+        final_positions.resize(plans.size());
+        auto t_batch_start = Profiler::Clock::now();
+        pool->parallelFor(plans.size() - round_begin, [&](size_t worker, size_t k) {
+            if ((round_begin > 0 || k > 0) && deadline.expired()) {
+                return;
+            }
+            Profiler::Scope rollout_scope(*profiler, Profiler::ROLLOUT);
+            size_t i = evaluation_order[round_begin + k];
+            int limit = bound.load(std::memory_order_relaxed);
+            // The cached plan only counts as still damage free if it was rolled out to the end
+            if (warm_plan && i == strategic_count) {
+                limit = std::max(limit, 0);
+            }
+            auto sim_unit(myUnit);
+            damages[i] = rollout(worker_simulators[worker], sim_unit, plans[i], limit);
+            int seen = bound.load(std::memory_order_relaxed);
+            while (damages[i] < seen && !bound.compare_exchange_weak(seen, damages[i], std::memory_order_relaxed)) {}
+            shot_credits[i] = worker_simulators[worker].shot_credit;
+            final_positions[i] = sim_unit.position;
+            evaluated[i] = true;
+        });
+        profiler->record(Profiler::SIMULATE_BATCH, t_batch_start);
+
+        if (!searching || deadline.expired()) {
+            break;
+        }
+        if (generating) {
+            generator.feedback(plans.data() + round_begin, damages.data() + round_begin, plans.size() - round_begin);
+        } else {
+            // Dodge candidates never shoot, none of them can take less than no damage
+            if (warm_plan && damages[strategic_count] <= 0) {
+                ++simulator.plan_cache_hits;
+                break;
+            }
+            CandidateContext context;
+            context.velocity = myUnit.velocity.isEmpty() ? default_dir : myUnit.velocity;
+            context.speed = constants.maxUnitForwardSpeed;
+            context.direction = myUnit.direction;
+            context.horizon = simulator.simulated_ticks;
+            context.warm_plan = warm_plan ? &*warm_plan : nullptr;
+            context.seed = simulator.started_tick * 1000003u + myUnit.id;
+            generator.begin(context);
+            generating = true;
+        }
+        round_begin = plans.size();
+        if (!generator.next(plans)) {
+            break;
+        }
+    }
+
+    // Reduce in candidate order so ties resolve exactly like a serial scan
+    for (size_t i = 0; i < plans.size(); ++i) {
+        if (!evaluated[i]) {
+            ++simulator.skipped_candidates;
             continue;
-        if (b.second.shooterId == myUnit.id) continue;
-
-        sim_bullets.emplace_back(b.second);
-    }
-
-    for (auto& order: orders) {
-        auto sim_unit(myUnit);
-        for (auto& b: sim_bullets) {
-            b.position = bullets.at(b.id).position;
-            b.lifeTime = bullets.at(b.id).lifeTime;
-            b.destroyed = false;
         }
-
-        auto damage = simulator.Simulate(sim_unit, order, sim_bullets, obstacles, zone, simulator.started_tick);
-        if (damage < min_damage) {
-            min_damage = damage;
-            best_order = &order;
+        if (damages[i] < min_damage) {
+            min_damage = damages[i];
+            best = i;
         }
 
         if (debugInterface) {
-            debugInterface->addRing(sim_unit.position, constants.unitRadius, 0.1, debugging::Color(0, 0, 1, 1));
-            debugInterface->addPlacedText(sim_unit.position, std::to_string(damage), {0, -1}, 0.3, debugging::Color(0, 0, 0, 0.5));
+            debugInterface->addRing(final_positions[i], constants.unitRadius, 0.1, debugging::Color(0, 0, 1, 1));
+            debugInterface->addPlacedNumber(final_positions[i], damages[i], {0, -1}, 0.3, debugging::Color(0, 0, 0, 0.5));
+        }
+    }
+    if (!bullets.empty()) {
+        simulator.planned_damage += min_damage + shot_credits[best];
+    }
+    if (best >= strategic_count) {
+        // Rolled out once more, the batch above kept no trajectories
+        auto sim_unit(myUnit);
+        rollout(simulator, sim_unit, plans[best], INT_MAX);
+        auto& trajectory = simulator.trajectory;
+        dodge_plan = CachedPlan{ simulator.started_tick, plans[best], std::vector<model::Vec2>(trajectory.begin(), trajectory.begin() + simulator.simulated_ticks), min_damage };
+        if (debugInterface) {
+            debugInterface->addPolyLine(dodge_plan->trajectory, 0.1, debugging::Color(0, 1, 0, 0.5));
+            debugInterface->addPlacedNumber(dodge_plan->trajectory.back(), dodge_plan->damage, {0, 1}, 0.3, debugging::Color(0, 0.5, 0, 1));
         }
     }
 
+    const model::UnitOrder& best_order = plans[best].first();
     if (debugInterface) {
-        debugInterface->addPolyLine({myUnit.position, myUnit.position + best_order->targetVelocity}, 0.1, debugging::Color(1, 0, 0, 1));
-        debugInterface->addPolyLine({myUnit.position, myUnit.position + best_order->targetDirection}, 0.1, debugging::Color(1, 0, 0, 1));
+        debugInterface->addPolyLine({myUnit.position, myUnit.position + best_order.targetVelocity}, 0.1, debugging::Color(1, 0, 0, 1));
+        debugInterface->addPolyLine({myUnit.position, myUnit.position + best_order.targetDirection}, 0.1, debugging::Color(1, 0, 0, 1));
+    }
+
+    return best_order;
+}
+
+std::vector<size_t> MyStrategy::prioritizeCandidates(
+        const model::Unit& myUnit,
+        const std::vector<Plan>& plans,
+        size_t strategic_count,
+        const DangerMap& danger_map,
+        int ticks) const {
+    std::vector<size_t> evaluation_order(plans.size());
+    for (size_t i = 0; i < plans.size(); ++i) {
+        evaluation_order[i] = i;
+    }
+    if (plans.size() <= strategic_count + 1) {
+        return evaluation_order;
+    }
+
+    // Ticks on which the unit moving straight at full speed would be in a dangerous cell.
+    // Paths ending in the zone damage ring are doomed and go last, so the deadline drops them first.
+    std::vector<int> danger(plans.size(), 0);
+    for (size_t i = strategic_count; i < plans.size(); ++i) {
+        auto step = plans[i].first().targetVelocity.clone().norm() * (constants.maxUnitForwardSpeed * delta_time);
+        auto point = myUnit.position;
+        for (int tick = 0; tick < ticks; ++tick) {
+            danger[i] += danger_map.mayHit(point, tick, 0);
+            point += step;
+        }
+        if (danger_map.outsideZone(point)) {
+            danger[i] += ticks + 1;
+        }
     }
 
-    return *best_order;
+    std::stable_sort(evaluation_order.begin() + strategic_count, evaluation_order.end(), [&](size_t a, size_t b) {
+        return danger[a] < danger[b];
+    });
+    return evaluation_order;
 }
 
 void MyStrategy::shooting(
         const model::Unit& myUnit,
         const model::Unit* nearest_enemy,
-        std::vector<const model::Obstacle*>& obstacles,
-        std::vector<model::UnitOrder>& orders) {
+        std::vector<model::UnitOrder>& orders,
+        Simulator& simulator) {
+    Profiler::Scope scope(*profiler, Profiler::SHOOTING);
     bool shooting = false;
     double aim_delta = 1.0 / constants.weapons[*myUnit.weapon].aimTime / constants.ticksPerSecond;
 
@@ -430,7 +645,7 @@ void MyStrategy::shooting(
     double time_to_hit = dist_to_enemy / constants.weapons[*myUnit.weapon].projectileSpeed;
     int ticks_to_hit = std::ceil(time_to_hit * constants.ticksPerSecond);
     auto sim_enemy(*nearest_enemy);
-    simulator.SimulateEnemyMovement(sim_enemy, obstacles, simulator.started_tick + 30 - ticks_to_hit);
+    simulator.SimulateEnemyMovement(sim_enemy, simulator.started_tick + simulator.simulated_ticks - ticks_to_hit);
 
     bool can_shoot = myUnit.nextShotTick - simulator.started_tick <= 15;
 
@@ -438,8 +653,9 @@ void MyStrategy::shooting(
         double min_dist_to_obstacle = 1e9;
         double min_dist_to_ally = 1e9;
 
+        std::vector<const model::Obstacle*> obstacles;
+        obstacle_grid.querySegment(bullet.position, bullet.position + bullet.velocity * bullet.lifeTime, 0, true, obstacles);
         for (auto& obstacle: obstacles) {
-            if (obstacle->canShootThrough) continue;
             auto hit = bullet.getHit(*obstacle);
             if (hit) {
                 min_dist_to_obstacle = std::min(min_dist_to_obstacle, hit->distTo(bullet.position));
@@ -462,16 +678,15 @@ void MyStrategy::shooting(
     auto move = (nearest_enemy->position - myUnit.position).mul(constants.maxUnitForwardSpeed);
     auto min_dist_to_enemy = nearest_enemy->position.distToSquared(myUnit.position);
     if (dist_coef * min_dist_to_enemy < constants.viewDistance * constants.viewDistance) {
-        move.rotate(M_PI);
+        move = move * -1;
     }
 
-    for (size_t it = 0; it < 16; ++it) {
+    for (int it = 0; it < FAN_16.size(); ++it) {
         orders.emplace_back(
-            move,
+            move.rotated(FAN_16[it]),
             sim_enemy.position - myUnit.position,
             can_shoot ? std::optional<model::ActionOrder>(model::Aim(shooting)) : std::nullopt
         );
-        move.rotate(M_PI / 8);
     }
 }
 
@@ -487,17 +702,18 @@ std::optional<model::UnitOrder> MyStrategy::healing(const model::Unit& myUnit) c
     return std::nullopt;
 }
 
-std::optional<model::UnitOrder> MyStrategy::looting(const model::Unit& myUnit, const model::Zone& zone) {
+std::optional<model::UnitOrder> MyStrategy::looting(const model::Unit& myUnit, const model::Zone& zone, LootReservations& busy_loot) const {
+    Profiler::Scope scope(*profiler, Profiler::LOOTING);
     if (loots.empty()) {
         return std::nullopt;
     }
 
     double min_dist = 1e9;
-    model::Loot* nearest_loot = nullptr;
-    for (auto& [id, loot]: loots) {
+    const model::Loot* nearest_loot = nullptr;
+    for (auto& loot: loots) {
         bool busy = false;
         for (auto& [key_l, l]: busy_loot) {
-            if (l == id) {
+            if (l == loot.id) {
                 busy = true;
                 break;
             }
@@ -513,7 +729,7 @@ std::optional<model::UnitOrder> MyStrategy::looting(const model::Unit& myUnit, c
 
         double min_dist_to_me = loot.position.distToSquared(myUnit.position);
         double min_dist_to_enemy = 1e9;
-        for (auto& [id, enemy] : enemies) {
+        for (auto& enemy : enemies) {
             min_dist_to_enemy = std::min(
                 min_dist_to_enemy,
                 loot.position.distToSquared(enemy.position));
@@ -585,5 +801,11 @@ std::optional<model::UnitOrder> MyStrategy::looting(const model::Unit& myUnit, c
 void MyStrategy::debugUpdate(int displayedTick, DebugInterface& dbgInterface) {}
 
 void MyStrategy::finish() {
-    std::cout << "Last tick " << simulator.started_tick << " -- " << "Elapsed time " << elapsed_time << " ms" << std::endl;
+    profiler->endTicks();
+    std::cout << "Last tick " << simulator.started_tick << " -- " << "Elapsed time " << spent_time_us / 1000 << " ms" << std::endl;
+    std::cout << "Candidates skipped by deadline " << skipped_candidates << std::endl;
+    if (planned_ticks > 0) {
+        std::cout << "Team decision avg " << total_team_latency / planned_ticks << " us, max " << max_team_latency << " us" << std::endl;
+    }
+    profiler->dump(std::cout);
 }
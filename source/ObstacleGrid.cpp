@@ -0,0 +1,127 @@
+#include "ObstacleGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+void ObstacleGrid::build(const std::vector<model::Obstacle>& obs, double size) {
+    obstacles = &obs;
+    cell_size = size;
+    cell_start.clear();
+    cell_items.clear();
+    if (obs.empty()) {
+        width = height = 0;
+        return;
+    }
+
+    model::Vec2 min(1e18, 1e18);
+    model::Vec2 max(-1e18, -1e18);
+    for (auto& obstacle : obs) {
+        min.x = std::min(min.x, obstacle.position.x - obstacle.radius);
+        min.y = std::min(min.y, obstacle.position.y - obstacle.radius);
+        max.x = std::max(max.x, obstacle.position.x + obstacle.radius);
+        max.y = std::max(max.y, obstacle.position.y + obstacle.radius);
+    }
+    origin = min;
+    width = (int)std::floor((max.x - min.x) / cell_size) + 1;
+    height = (int)std::floor((max.y - min.y) / cell_size) + 1;
+
+    // Counting pass then fill pass, cells end up as one flat array
+    std::vector<int> counts(width * height, 0);
+    for (auto& obstacle : obs) {
+        for (int cy = cellY(obstacle.position.y - obstacle.radius); cy <= cellY(obstacle.position.y + obstacle.radius); ++cy) {
+            for (int cx = cellX(obstacle.position.x - obstacle.radius); cx <= cellX(obstacle.position.x + obstacle.radius); ++cx) {
+                counts[cy * width + cx]++;
+            }
+        }
+    }
+
+    cell_start.assign(width * height + 1, 0);
+    for (int i = 0; i < width * height; ++i) {
+        cell_start[i + 1] = cell_start[i] + counts[i];
+    }
+    cell_items.resize(cell_start.back());
+
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int index = 0; index < (int)obs.size(); ++index) {
+        auto& obstacle = obs[index];
+        for (int cy = cellY(obstacle.position.y - obstacle.radius); cy <= cellY(obstacle.position.y + obstacle.radius); ++cy) {
+            for (int cx = cellX(obstacle.position.x - obstacle.radius); cx <= cellX(obstacle.position.x + obstacle.radius); ++cx) {
+                int cell = cy * width + cx;
+                cell_items[cell_start[cell] + counts[cell]++] = index;
+            }
+        }
+    }
+}
+
+int ObstacleGrid::cellX(double x) const {
+    return std::clamp((int)std::floor((x - origin.x) / cell_size), 0, width - 1);
+}
+
+int ObstacleGrid::cellY(double y) const {
+    return std::clamp((int)std::floor((y - origin.y) / cell_size), 0, height - 1);
+}
+
+template<typename Accept>
+void ObstacleGrid::query(const model::Vec2& min, const model::Vec2& max, bool blocking_shots_only, std::vector<const model::Obstacle*>& out, Accept accept) const {
+    out.clear();
+    if (empty() || max.x < origin.x || max.y < origin.y ||
+        min.x > origin.x + width * cell_size || min.y > origin.y + height * cell_size) {
+        return;
+    }
+
+    int x0 = cellX(min.x), x1 = cellX(max.x);
+    int y0 = cellY(min.y), y1 = cellY(max.y);
+    bool single_cell = x0 == x1 && y0 == y1;
+
+    // Indices are collected first so that duplicates from neighbouring cells can be dropped
+    thread_local std::vector<int> found;
+    found.clear();
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            int cell = cy * width + cx;
+            for (int i = cell_start[cell]; i < cell_start[cell + 1]; ++i) {
+                auto& obstacle = (*obstacles)[cell_items[i]];
+                if (blocking_shots_only && obstacle.canShootThrough) {
+                    continue;
+                }
+                if (accept(obstacle)) {
+                    found.push_back(cell_items[i]);
+                }
+            }
+        }
+    }
+
+    if (!single_cell) {
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+    }
+    for (int index : found) {
+        out.push_back(&(*obstacles)[index]);
+    }
+}
+
+void ObstacleGrid::queryCircle(const model::Vec2& center, double radius, bool blocking_shots_only, std::vector<const model::Obstacle*>& out) const {
+    model::Vec2 extent(radius, radius);
+    query(center - extent, center + extent, blocking_shots_only, out, [&](const model::Obstacle& obstacle) {
+        return center.distTo(obstacle.position) - obstacle.radius < radius;
+    });
+}
+
+void ObstacleGrid::querySegment(const model::Vec2& from, const model::Vec2& to, double radius, bool blocking_shots_only, std::vector<const model::Obstacle*>& out) const {
+    model::Vec2 min(std::min(from.x, to.x) - radius, std::min(from.y, to.y) - radius);
+    model::Vec2 max(std::max(from.x, to.x) + radius, std::max(from.y, to.y) + radius);
+    auto dir = to - from;
+    double len_sq = dir.dot(dir);
+    query(min, max, blocking_shots_only, out, [&](const model::Obstacle& obstacle) {
+        double t = len_sq > 0 ? std::clamp((obstacle.position - from).dot(dir) / len_sq, 0.0, 1.0) : 0.0;
+        auto closest = from + dir * t;
+        double reach = radius + obstacle.radius;
+        return closest.distToSquared(obstacle.position) <= reach * reach;
+    });
+}
+
+void ObstacleGrid::queryBox(const model::Vec2& min, const model::Vec2& max, bool blocking_shots_only, std::vector<const model::Obstacle*>& out) const {
+    query(min, max, blocking_shots_only, out, [&](const model::Obstacle& obstacle) {
+        return obstacle.position.x + obstacle.radius >= min.x && obstacle.position.x - obstacle.radius <= max.x &&
+            obstacle.position.y + obstacle.radius >= min.y && obstacle.position.y - obstacle.radius <= max.y;
+    });
+}
@@ -0,0 +1,173 @@
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+LatencyHistogram::LatencyHistogram() : buckets(bucketOf(UINT64_MAX) + 1, 0) {}
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+    int shift = 0;
+    while ((value >> shift) >= 2 * SUB_BUCKETS) {
+        ++shift;
+    }
+    return shift * SUB_BUCKETS + (value >> shift);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t top = bucket % SUB_BUCKETS + SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    ++buckets[bucketOf(value)];
+    ++total;
+    max_value = std::max(max_value, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    total += other.total;
+    max_value = std::max(max_value, other.max_value);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    total = 0;
+    max_value = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(fraction * total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), max_value);
+        }
+    }
+    return max_value;
+}
+
+Profiler::Profiler(size_t workers) : slots(std::max<size_t>(1, workers)) {}
+
+void Profiler::stream(const std::string& path) {
+    stream_file.open(path, std::ios::trunc);
+    if (!stream_file) {
+        throw std::runtime_error("Failed to open profile file " + path);
+    }
+}
+
+void Profiler::record(Phase phase, uint64_t ns) {
+    auto& slot = slots[ThreadPool::currentWorker()];
+    slot.phases[phase].record(ns);
+    slot.tick_phase_ns[phase] += ns;
+}
+
+void Profiler::add(Counter counter, uint64_t value) {
+    tick_counters[counter] += value;
+}
+
+void Profiler::beginTick(int tick) {
+    closeTick();
+    current_tick = tick;
+}
+
+void Profiler::endTicks() {
+    closeTick();
+    current_tick = -1;
+    if (stream_file.is_open()) {
+        stream_file.flush();
+    }
+}
+
+void Profiler::closeTick() {
+    if (current_tick < 0) {
+        return;
+    }
+
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        counters[c].record(tick_counters[c]);
+    }
+
+    if (stream_file.is_open()) {
+        stream_file << "{\"tick\":" << current_tick;
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            uint64_t ns = 0;
+            for (auto& slot : slots) {
+                ns += slot.tick_phase_ns[p];
+            }
+            stream_file << ",\"" << phaseName(Phase(p)) << "_ns\":" << ns;
+        }
+        for (int c = 0; c < COUNTER_COUNT; ++c) {
+            stream_file << ",\"" << counterName(Counter(c)) << "\":" << tick_counters[c];
+        }
+        stream_file << "}\n";
+    }
+
+    for (auto& slot : slots) {
+        std::fill(slot.tick_phase_ns, slot.tick_phase_ns + PHASE_COUNT, 0);
+    }
+    std::fill(tick_counters, tick_counters + COUNTER_COUNT, 0);
+}
+
+void Profiler::dump(std::ostream& out) const {
+    out << "Phase latency, us: count p50 p99 max" << std::endl;
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        LatencyHistogram merged;
+        for (auto& slot : slots) {
+            merged.merge(slot.phases[p]);
+        }
+        if (merged.count() == 0) {
+            continue;
+        }
+        out << "  " << phaseName(Phase(p)) << ": " << merged.count()
+            << " " << merged.percentile(0.5) / 1000.0
+            << " " << merged.percentile(0.99) / 1000.0
+            << " " << merged.max() / 1000.0 << std::endl;
+    }
+    out << "Per tick counters: p50 p99 max" << std::endl;
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        out << "  " << counterName(Counter(c)) << ": " << counters[c].percentile(0.5)
+            << " " << counters[c].percentile(0.99)
+            << " " << counters[c].max() << std::endl;
+    }
+}
+
+const char* Profiler::phaseName(Phase phase) {
+    switch (phase) {
+        case TICK: return "tick";
+        case INGESTION: return "ingestion";
+        case TEAM_PLAN: return "team_plan";
+        case UNIT_ORDER: return "unit_order";
+        case SHOOTING: return "shooting";
+        case LOOTING: return "looting";
+        case SIMULATE_BATCH: return "simulate_batch";
+        case ROLLOUT: return "rollout";
+        case WORLD_UPDATE: return "world_update";
+        case SERIALIZATION: return "serialization";
+        default: return "unknown";
+    }
+}
+
+const char* Profiler::counterName(Counter counter) {
+    switch (counter) {
+        case ROLLOUTS: return "rollouts";
+        case SIMULATED_BULLETS: return "simulated_bullets";
+        case RECV_CALLS: return "recv_calls";
+        case SEND_CALLS: return "send_calls";
+        case PLANNED_DAMAGE: return "planned_damage";
+        case PLAN_CACHE_HITS: return "plan_cache_hits";
+        case PRUNED_TICKS: return "pruned_ticks";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,372 @@
+#include "ProjectileBatch.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+template<typename T>
+void ProjectileBatchT<T>::clear() {
+    count = 0;
+    ids.clear();
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    life.clear();
+    damage.clear();
+}
+
+template<typename T>
+void ProjectileBatchT<T>::add(const model::Projectile& projectile, const model::Constants& constants) {
+    size_t i = count++;
+    pad();
+
+    ids[i] = projectile.id;
+    x[i] = projectile.position.x;
+    y[i] = projectile.position.y;
+    vx[i] = projectile.velocity.x;
+    vy[i] = projectile.velocity.y;
+    life[i] = projectile.destroyed ? -1 : projectile.lifeTime;
+    damage[i] = constants.weapons[projectile.weaponTypeIndex].projectileDamage;
+}
+
+template<typename T>
+void ProjectileBatchT<T>::assign(const std::vector<model::Projectile>& projectiles, const model::Constants& constants) {
+    clear();
+    for (auto& projectile : projectiles) {
+        add(projectile, constants);
+    }
+}
+
+template<typename T>
+void ProjectileBatchT<T>::compact() {
+    size_t alive_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!alive(i)) {
+            continue;
+        }
+        if (i != alive_count) {
+            ids[alive_count] = ids[i];
+            x[alive_count] = x[i];
+            y[alive_count] = y[i];
+            vx[alive_count] = vx[i];
+            vy[alive_count] = vy[i];
+            life[alive_count] = life[i];
+            damage[alive_count] = damage[i];
+        }
+        ++alive_count;
+    }
+
+    for (size_t i = alive_count; i < paddedSize(); ++i) {
+        life[i] = -1;
+    }
+    count = alive_count;
+}
+
+template<typename T>
+void ProjectileBatchT<T>::sweptBounds(T time, model::Vec2T<T>& min, model::Vec2T<T>& max) const {
+    min = model::Vec2T<T>(1e18, 1e18);
+    max = model::Vec2T<T>(-1e18, -1e18);
+    for (size_t i = 0; i < count; ++i) {
+        T x1 = x[i] + vx[i] * time;
+        T y1 = y[i] + vy[i] * time;
+        min.x = std::min(min.x, std::min(x[i], x1));
+        min.y = std::min(min.y, std::min(y[i], y1));
+        max.x = std::max(max.x, std::max(x[i], x1));
+        max.y = std::max(max.y, std::max(y[i], y1));
+    }
+}
+
+template<typename T>
+void ProjectileBatchT<T>::pad() {
+    size_t padded = (count + LANES - 1) / LANES * LANES;
+    ids.resize(padded, -1);
+    x.resize(padded, 0);
+    y.resize(padded, 0);
+    vx.resize(padded, 0);
+    vy.resize(padded, 0);
+    life.resize(padded, -1);
+    damage.resize(padded, 0);
+}
+
+namespace {
+
+// Plain loop, the fallback of both kernels
+template<typename T>
+void sweptHitsScalar(
+        const ProjectileBatchT<T>& batch,
+        size_t n,
+        const model::Vec2T<T>& center,
+        const model::Vec2T<T>& velocity,
+        T radius_sq,
+        T max_time,
+        T* out,
+        bool keep_min) {
+    for (size_t i = 0; i < n; ++i) {
+        T c0x = batch.x[i] - center.x;
+        T c0y = batch.y[i] - center.y;
+        T vx_ = batch.vx[i] - velocity.x;
+        T vy_ = batch.vy[i] - velocity.y;
+        T a = vx_ * vx_ + vy_ * vy_;
+        T b = 2 * c0x * vx_ + 2 * c0y * vy_;
+        T c = c0x * c0x + c0y * c0y - radius_sq;
+        T d = b * b - 4 * a * c;
+
+        T res = ProjectileBatchT<T>::NO_HIT;
+        if (d >= 0) {
+            T t1 = (-b + std::sqrt(d)) / 2 / a;
+            T t2 = (-b - std::sqrt(d)) / 2 / a;
+            T t = t1 < 0 ? t2 : (t2 < 0 ? t1 : std::min(t1, t2));
+            if (t >= 0 && t <= max_time && t <= batch.life[i]) {
+                res = t;
+            }
+        }
+        out[i] = keep_min ? std::min(res, out[i]) : res;
+    }
+}
+
+void sweptHits(
+        const ProjectileBatchT<double>& batch,
+        size_t n,
+        const model::Vec2& center,
+        const model::Vec2& velocity,
+        double radius_sq,
+        double max_time,
+        double* out,
+        bool keep_min) {
+#if defined(__AVX2__)
+    const __m256d cx = _mm256_set1_pd(center.x);
+    const __m256d cy = _mm256_set1_pd(center.y);
+    const __m256d cvx = _mm256_set1_pd(velocity.x);
+    const __m256d cvy = _mm256_set1_pd(velocity.y);
+    const __m256d r2 = _mm256_set1_pd(radius_sq);
+    const __m256d tmax = _mm256_set1_pd(max_time);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d four = _mm256_set1_pd(4.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d no_hit = _mm256_set1_pd(ProjectileBatchT<double>::NO_HIT);
+    for (size_t i = 0; i < n; i += 4) {
+        __m256d c0x = _mm256_sub_pd(_mm256_loadu_pd(&batch.x[i]), cx);
+        __m256d c0y = _mm256_sub_pd(_mm256_loadu_pd(&batch.y[i]), cy);
+        __m256d vx_ = _mm256_sub_pd(_mm256_loadu_pd(&batch.vx[i]), cvx);
+        __m256d vy_ = _mm256_sub_pd(_mm256_loadu_pd(&batch.vy[i]), cvy);
+        __m256d l = _mm256_loadu_pd(&batch.life[i]);
+
+        __m256d a = _mm256_add_pd(_mm256_mul_pd(vx_, vx_), _mm256_mul_pd(vy_, vy_));
+        __m256d b = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(two, c0x), vx_), _mm256_mul_pd(_mm256_mul_pd(two, c0y), vy_));
+        __m256d c = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(c0x, c0x), _mm256_mul_pd(c0y, c0y)), r2);
+        __m256d d = _mm256_sub_pd(_mm256_mul_pd(b, b), _mm256_mul_pd(_mm256_mul_pd(four, a), c));
+        __m256d has_root = _mm256_cmp_pd(d, zero, _CMP_GE_OQ);
+        if (_mm256_movemask_pd(has_root) == 0) {
+            if (!keep_min) {
+                _mm256_storeu_pd(&out[i], no_hit);
+            }
+            continue;
+        }
+
+        __m256d sd = _mm256_sqrt_pd(_mm256_max_pd(d, zero));
+        __m256d nb = _mm256_xor_pd(b, sign);
+        __m256d t1 = _mm256_div_pd(_mm256_div_pd(_mm256_add_pd(nb, sd), two), a);
+        __m256d t2 = _mm256_div_pd(_mm256_div_pd(_mm256_sub_pd(nb, sd), two), a);
+        __m256d t = _mm256_blendv_pd(
+            _mm256_blendv_pd(_mm256_min_pd(t1, t2), t1, _mm256_cmp_pd(t2, zero, _CMP_LT_OQ)),
+            t2,
+            _mm256_cmp_pd(t1, zero, _CMP_LT_OQ));
+
+        __m256d valid = _mm256_and_pd(
+            _mm256_and_pd(has_root, _mm256_cmp_pd(t, zero, _CMP_GE_OQ)),
+            _mm256_and_pd(_mm256_cmp_pd(t, tmax, _CMP_LE_OQ), _mm256_cmp_pd(t, l, _CMP_LE_OQ)));
+        __m256d res = _mm256_blendv_pd(no_hit, t, valid);
+        if (keep_min) {
+            res = _mm256_min_pd(res, _mm256_loadu_pd(&out[i]));
+        }
+        _mm256_storeu_pd(&out[i], res);
+    }
+#elif defined(__SSE2__)
+    const __m128d cx = _mm_set1_pd(center.x);
+    const __m128d cy = _mm_set1_pd(center.y);
+    const __m128d cvx = _mm_set1_pd(velocity.x);
+    const __m128d cvy = _mm_set1_pd(velocity.y);
+    const __m128d r2 = _mm_set1_pd(radius_sq);
+    const __m128d tmax = _mm_set1_pd(max_time);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d two = _mm_set1_pd(2.0);
+    const __m128d four = _mm_set1_pd(4.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d no_hit = _mm_set1_pd(ProjectileBatchT<double>::NO_HIT);
+    auto select = [](__m128d mask, __m128d if_true, __m128d if_false) {
+        return _mm_or_pd(_mm_and_pd(mask, if_true), _mm_andnot_pd(mask, if_false));
+    };
+    for (size_t i = 0; i < n; i += 2) {
+        __m128d c0x = _mm_sub_pd(_mm_loadu_pd(&batch.x[i]), cx);
+        __m128d c0y = _mm_sub_pd(_mm_loadu_pd(&batch.y[i]), cy);
+        __m128d vx_ = _mm_sub_pd(_mm_loadu_pd(&batch.vx[i]), cvx);
+        __m128d vy_ = _mm_sub_pd(_mm_loadu_pd(&batch.vy[i]), cvy);
+        __m128d l = _mm_loadu_pd(&batch.life[i]);
+
+        __m128d a = _mm_add_pd(_mm_mul_pd(vx_, vx_), _mm_mul_pd(vy_, vy_));
+        __m128d b = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(two, c0x), vx_), _mm_mul_pd(_mm_mul_pd(two, c0y), vy_));
+        __m128d c = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(c0x, c0x), _mm_mul_pd(c0y, c0y)), r2);
+        __m128d d = _mm_sub_pd(_mm_mul_pd(b, b), _mm_mul_pd(_mm_mul_pd(four, a), c));
+        __m128d has_root = _mm_cmpge_pd(d, zero);
+        if (_mm_movemask_pd(has_root) == 0) {
+            if (!keep_min) {
+                _mm_storeu_pd(&out[i], no_hit);
+            }
+            continue;
+        }
+
+        __m128d sd = _mm_sqrt_pd(_mm_max_pd(d, zero));
+        __m128d nb = _mm_xor_pd(b, sign);
+        __m128d t1 = _mm_div_pd(_mm_div_pd(_mm_add_pd(nb, sd), two), a);
+        __m128d t2 = _mm_div_pd(_mm_div_pd(_mm_sub_pd(nb, sd), two), a);
+        __m128d t = select(_mm_cmplt_pd(t1, zero), t2, select(_mm_cmplt_pd(t2, zero), t1, _mm_min_pd(t1, t2)));
+
+        __m128d valid = _mm_and_pd(
+            _mm_and_pd(has_root, _mm_cmpge_pd(t, zero)),
+            _mm_and_pd(_mm_cmple_pd(t, tmax), _mm_cmple_pd(t, l)));
+        __m128d res = select(valid, t, no_hit);
+        if (keep_min) {
+            res = _mm_min_pd(res, _mm_loadu_pd(&out[i]));
+        }
+        _mm_storeu_pd(&out[i], res);
+    }
+#else
+    sweptHitsScalar(batch, n, center, velocity, radius_sq, max_time, out, keep_min);
+#endif
+}
+
+// The same kernel on twice as many lanes
+void sweptHits(
+        const ProjectileBatchT<float>& batch,
+        size_t n,
+        const model::Vec2f& center,
+        const model::Vec2f& velocity,
+        float radius_sq,
+        float max_time,
+        float* out,
+        bool keep_min) {
+#if defined(__AVX2__)
+    const __m256 cx = _mm256_set1_ps(center.x);
+    const __m256 cy = _mm256_set1_ps(center.y);
+    const __m256 cvx = _mm256_set1_ps(velocity.x);
+    const __m256 cvy = _mm256_set1_ps(velocity.y);
+    const __m256 r2 = _mm256_set1_ps(radius_sq);
+    const __m256 tmax = _mm256_set1_ps(max_time);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 no_hit = _mm256_set1_ps(ProjectileBatchT<float>::NO_HIT);
+    for (size_t i = 0; i < n; i += 8) {
+        __m256 c0x = _mm256_sub_ps(_mm256_loadu_ps(&batch.x[i]), cx);
+        __m256 c0y = _mm256_sub_ps(_mm256_loadu_ps(&batch.y[i]), cy);
+        __m256 vx_ = _mm256_sub_ps(_mm256_loadu_ps(&batch.vx[i]), cvx);
+        __m256 vy_ = _mm256_sub_ps(_mm256_loadu_ps(&batch.vy[i]), cvy);
+        __m256 l = _mm256_loadu_ps(&batch.life[i]);
+
+        __m256 a = _mm256_add_ps(_mm256_mul_ps(vx_, vx_), _mm256_mul_ps(vy_, vy_));
+        __m256 b = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(two, c0x), vx_), _mm256_mul_ps(_mm256_mul_ps(two, c0y), vy_));
+        __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(c0x, c0x), _mm256_mul_ps(c0y, c0y)), r2);
+        __m256 d = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(_mm256_mul_ps(four, a), c));
+        __m256 has_root = _mm256_cmp_ps(d, zero, _CMP_GE_OQ);
+        if (_mm256_movemask_ps(has_root) == 0) {
+            if (!keep_min) {
+                _mm256_storeu_ps(&out[i], no_hit);
+            }
+            continue;
+        }
+
+        __m256 sd = _mm256_sqrt_ps(_mm256_max_ps(d, zero));
+        __m256 nb = _mm256_xor_ps(b, sign);
+        __m256 t1 = _mm256_div_ps(_mm256_div_ps(_mm256_add_ps(nb, sd), two), a);
+        __m256 t2 = _mm256_div_ps(_mm256_div_ps(_mm256_sub_ps(nb, sd), two), a);
+        __m256 t = _mm256_blendv_ps(
+            _mm256_blendv_ps(_mm256_min_ps(t1, t2), t1, _mm256_cmp_ps(t2, zero, _CMP_LT_OQ)),
+            t2,
+            _mm256_cmp_ps(t1, zero, _CMP_LT_OQ));
+
+        __m256 valid = _mm256_and_ps(
+            _mm256_and_ps(has_root, _mm256_cmp_ps(t, zero, _CMP_GE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(t, tmax, _CMP_LE_OQ), _mm256_cmp_ps(t, l, _CMP_LE_OQ)));
+        __m256 res = _mm256_blendv_ps(no_hit, t, valid);
+        if (keep_min) {
+            res = _mm256_min_ps(res, _mm256_loadu_ps(&out[i]));
+        }
+        _mm256_storeu_ps(&out[i], res);
+    }
+#elif defined(__SSE2__)
+    const __m128 cx = _mm_set1_ps(center.x);
+    const __m128 cy = _mm_set1_ps(center.y);
+    const __m128 cvx = _mm_set1_ps(velocity.x);
+    const __m128 cvy = _mm_set1_ps(velocity.y);
+    const __m128 r2 = _mm_set1_ps(radius_sq);
+    const __m128 tmax = _mm_set1_ps(max_time);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 no_hit = _mm_set1_ps(ProjectileBatchT<float>::NO_HIT);
+    auto select = [](__m128 mask, __m128 if_true, __m128 if_false) {
+        return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+    };
+    for (size_t i = 0; i < n; i += 4) {
+        __m128 c0x = _mm_sub_ps(_mm_loadu_ps(&batch.x[i]), cx);
+        __m128 c0y = _mm_sub_ps(_mm_loadu_ps(&batch.y[i]), cy);
+        __m128 vx_ = _mm_sub_ps(_mm_loadu_ps(&batch.vx[i]), cvx);
+        __m128 vy_ = _mm_sub_ps(_mm_loadu_ps(&batch.vy[i]), cvy);
+        __m128 l = _mm_loadu_ps(&batch.life[i]);
+
+        __m128 a = _mm_add_ps(_mm_mul_ps(vx_, vx_), _mm_mul_ps(vy_, vy_));
+        __m128 b = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(two, c0x), vx_), _mm_mul_ps(_mm_mul_ps(two, c0y), vy_));
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(c0x, c0x), _mm_mul_ps(c0y, c0y)), r2);
+        __m128 d = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_mul_ps(four, a), c));
+        __m128 has_root = _mm_cmpge_ps(d, zero);
+        if (_mm_movemask_ps(has_root) == 0) {
+            if (!keep_min) {
+                _mm_storeu_ps(&out[i], no_hit);
+            }
+            continue;
+        }
+
+        __m128 sd = _mm_sqrt_ps(_mm_max_ps(d, zero));
+        __m128 nb = _mm_xor_ps(b, sign);
+        __m128 t1 = _mm_div_ps(_mm_div_ps(_mm_add_ps(nb, sd), two), a);
+        __m128 t2 = _mm_div_ps(_mm_div_ps(_mm_sub_ps(nb, sd), two), a);
+        __m128 t = select(_mm_cmplt_ps(t1, zero), t2, select(_mm_cmplt_ps(t2, zero), t1, _mm_min_ps(t1, t2)));
+
+        __m128 valid = _mm_and_ps(
+            _mm_and_ps(has_root, _mm_cmpge_ps(t, zero)),
+            _mm_and_ps(_mm_cmple_ps(t, tmax), _mm_cmple_ps(t, l)));
+        __m128 res = select(valid, t, no_hit);
+        if (keep_min) {
+            res = _mm_min_ps(res, _mm_loadu_ps(&out[i]));
+        }
+        _mm_storeu_ps(&out[i], res);
+    }
+#else
+    sweptHitsScalar(batch, n, center, velocity, radius_sq, max_time, out, keep_min);
+#endif
+}
+
+}
+
+template<typename T>
+void ProjectileBatchT<T>::sweptCircleHits(
+        const model::Vec2T<T>& center,
+        const model::Vec2T<T>& velocity,
+        T radius_sq,
+        T max_time,
+        T* out,
+        bool keep_min) const {
+    const size_t n = (count + LANES - 1) / LANES * LANES;
+    sweptHits(*this, n, center, velocity, radius_sq, max_time, out, keep_min);
+}
+
+template class ProjectileBatchT<double>;
+template class ProjectileBatchT<float>;
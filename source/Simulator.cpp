@@ -3,245 +3,307 @@
 #include <algorithm>
 #include <variant>
 
-const int SIMULATED_TICKS = 30;
-Simulator::Simulator(const model::Constants &constants) : constants(constants) {}
+namespace {
 
-std::optional<const model::Obstacle*> Simulator::SimulateMovement(model::Unit& unit, model::UnitOrder& order, const std::vector<const model::Obstacle*>& obstacles, int cur_tick) {
-    if (cur_tick - started_tick >= SIMULATED_TICKS)  {
-        return std::nullopt;
-    }
+bool wantsShot(const model::UnitOrder& order) {
+    return order.action && std::holds_alternative<model::Aim>(*order.action) && std::get<model::Aim>(*order.action).shoot;
+}
+
+}
+
+Simulator::Simulator(const model::Constants &constants) : constants(constants) {
+    setSimulatedTicks(simulated_ticks);
+}
+
+void Simulator::setSimulatedTicks(int ticks) {
+    simulated_ticks = std::clamp(ticks, 1, MAX_SIMULATED_TICKS);
+    tick_damage.assign(MAX_SIMULATED_TICKS, 0);
+    trajectory.assign(MAX_SIMULATED_TICKS, model::Vec2(0, 0));
+}
+
+void Simulator::setDeltaTime(double time) {
+    delta_time = time;
+    kinematics.build(constants, delta_time);
+}
 
-    int damage = 0;
+Simulator::Motion Simulator::beginMotion(const model::Unit& unit, const model::UnitOrder& order) const {
+    Motion motion;
+    motion.weapon = &kinematics.weapon(unit.weapon);
+    motion.aiming = order.action && std::holds_alternative<model::Aim>(*order.action);
+    motion.move_dir = order.targetVelocity.clone().norm();
+    motion.target_speed = order.targetVelocity.len();
+    motion.target_dir = order.targetDirection.clone().norm();
+    motion.rotates = !motion.target_dir.isEmpty();
+    // Limit for the aim before the first tick, simulateRotation moves it along with aim
+    motion.rotation_limit = motion.weapon->rotation_step - motion.weapon->rotation_slope * std::clamp(unit.aim, 0.0, 1.0);
+    motion.limit_cos = cos(motion.rotation_limit);
+    motion.limit_sin = sin(motion.rotation_limit);
+    return motion;
+}
+
+void Simulator::simulateRotation(model::Unit& unit, Motion& motion) const {
+    const WeaponKinematics& weapon = *motion.weapon;
 
     // SIMULATE UNIT AIM
-    if (unit.weapon && order.action && std::holds_alternative<model::Aim>(*order.action)) {
-        unit.aim += delta_time / constants.weapons[*unit.weapon].aimTime;
-    } else {
-        unit.aim -= delta_time / constants.weapons[*unit.weapon].aimTime;
+    double prev_aim = std::clamp(unit.aim, 0.0, 1.0);
+    if (unit.weapon) {
+        unit.aim += motion.aiming ? weapon.aim_step : -weapon.aim_step;
     }
     unit.aim = std::clamp(unit.aim, 0.0, 1.0);
 
+    // Rotation limit follows aim: table values at the ends, one angle step in between
+    if (unit.aim == 0) {
+        motion.rotation_limit = weapon.rotation_step;
+        motion.limit_cos = weapon.idle_cos;
+        motion.limit_sin = weapon.idle_sin;
+    } else if (unit.aim == 1) {
+        motion.rotation_limit = weapon.rotation_step - weapon.rotation_slope;
+        motion.limit_cos = weapon.aimed_cos;
+        motion.limit_sin = weapon.aimed_sin;
+    } else if (unit.aim != prev_aim) {
+        // Aim grows by aim_step, so the limit shrinks by one angle step, and the other way around
+        double step_sin = unit.aim > prev_aim ? -weapon.aim_step_sin : weapon.aim_step_sin;
+        double limit_cos = motion.limit_cos * weapon.aim_step_cos - motion.limit_sin * step_sin;
+        double limit_sin = motion.limit_sin * weapon.aim_step_cos + motion.limit_cos * step_sin;
+        motion.rotation_limit = weapon.rotation_step - weapon.rotation_slope * unit.aim;
+        motion.limit_cos = limit_cos;
+        motion.limit_sin = limit_sin;
+    }
+
     // SIMULATE UNIT ROTATION
-    double diff_angle = atan2(order.targetDirection.cross(unit.direction), order.targetDirection.dot(unit.direction)) * 180 / M_PI;
-    double aim_rotation_speed = unit.weapon ? constants.weapons[*unit.weapon].aimRotationSpeed : 0;
-    double rotation_speed = constants.rotationSpeed - (constants.rotationSpeed - aim_rotation_speed) * unit.aim;
-    double sign = diff_angle > 0 ? -1 : 1;
-
-    double angle_shift = sign * std::min(fabs(diff_angle), rotation_speed * delta_time) * M_PI / 180;
-    unit.direction.rotate(angle_shift);
-
-    // SIMULATE UNIT MOVEMENT
-    unit.calcSpeedCircle(constants);
-    auto move_dir = order.targetVelocity.clone().norm();
-    auto max_velocity_len = unit.getVelocity(move_dir).len();
+    if (!motion.rotates) {
+        return;
+    }
+    double cos_diff = motion.target_dir.dot(unit.direction);
+    if (motion.rotation_limit >= M_PI || cos_diff >= motion.limit_cos) {
+        unit.direction = motion.target_dir;
+        return;
+    }
+    double sin_shift = motion.target_dir.cross(unit.direction) > 0 ? -motion.limit_sin : motion.limit_sin;
+    unit.direction = model::Vec2(
+        unit.direction.x * motion.limit_cos - unit.direction.y * sin_shift,
+        unit.direction.x * sin_shift + unit.direction.y * motion.limit_cos);
+}
+
+void Simulator::simulateVelocity(model::Unit& unit, const model::UnitOrder& order, const Motion& motion) const {
+    // Speed circle scaled for the current aim, see Unit::calcSpeedCircle and Unit::getVelocity
+    double scale = 1 - motion.weapon->speed_slope * unit.aim;
+    double sin_a = unit.direction.cross(motion.move_dir);
+    double cos_a = unit.direction.dot(motion.move_dir);
+    double sin_b = kinematics.offset_ratio * sin_a;
+    double cos_b = sqrt(1 - sin_b * sin_b);
+    double cos_c = -cos_a * cos_b + sin_a * sin_b;
+    double max_velocity_len = scale * sqrt(kinematics.len_base - kinematics.len_cos * cos_c);
+
     model::Vec2 target_velocity;
-    if (max_velocity_len >= order.targetVelocity.len()) {
+    if (max_velocity_len >= motion.target_speed) {
         target_velocity = order.targetVelocity;
     } else {
-        target_velocity = move_dir.mul(max_velocity_len);
+        target_velocity = motion.move_dir * max_velocity_len;
     }
 
     auto velocity_shift = (target_velocity - unit.velocity);
-    if (velocity_shift.len() > constants.unitAcceleration * delta_time) {
-        velocity_shift.norm().mul(constants.unitAcceleration * delta_time);
+    double shift_sq = velocity_shift.x * velocity_shift.x + velocity_shift.y * velocity_shift.y;
+    if (shift_sq > kinematics.max_velocity_shift_sq) {
+        velocity_shift.mul(kinematics.max_velocity_shift / sqrt(shift_sq));
     }
     unit.velocity += velocity_shift;
+}
 
-    const model::Obstacle* collision = nullptr;
-    for (auto& obstacle : obstacles) {
-        auto hit = unit.hasHit(*obstacle);
-
-        if (hit && *hit <= delta_time) {
-            collision = obstacle;
-            unit.position = unit.position + unit.velocity * (*hit);
-            break;
-        }
-    }
-
-    if (!collision) {
-        unit.position = unit.position + unit.velocity * delta_time;
-        return SimulateMovement(unit, order, obstacles, cur_tick + 1);
-    } else {
-        return { collision };
-    }
+const std::vector<const model::Obstacle*>& Simulator::obstaclesInReach(const model::Unit& unit) {
+    obstacle_grid->queryCircle(unit.position, constants.unitRadius + unit.velocity.len() * delta_time + 1e-6, false, near_obstacles);
+    return near_obstacles;
 }
 
-void Simulator::SimulateEnemyMovement(model::Unit& unit, std::vector<const model::Obstacle*>& obstacles, int cur_tick) {
-    if (cur_tick - started_tick >= SIMULATED_TICKS)  {
-        return;
-    }
+std::optional<const model::Obstacle*> Simulator::SimulateMovement(model::Unit& unit, const model::UnitOrder& order, int cur_tick) {
+    Motion motion = beginMotion(unit, order);
+    for (; cur_tick - started_tick < simulated_ticks; ++cur_tick) {
+        simulateRotation(unit, motion);
 
-    int damage = 0;
+        // SIMULATE UNIT MOVEMENT
+        simulateVelocity(unit, order, motion);
 
-    bool has_collision = false;
-    for (auto& obstacle : obstacles) {
-        auto hit = unit.hasHit(*obstacle);
+        for (auto& obstacle : obstaclesInReach(unit)) {
+            auto hit = unit.hasHit(*obstacle);
 
-        if (hit && *hit <= delta_time) {
-            has_collision = true;
-            double f1_time = *hit;
-            double f2_time = delta_time - f1_time;
-            unit.next_position = unit.position + unit.velocity * f1_time;
-            auto v = (obstacle->position - unit.next_position).norm();
-            unit.velocity = model::Vec2(-v.y, v.x) * (v.cross(unit.velocity) / unit.velocity.len());
-            unit.next_position += unit.velocity * f2_time;
-            break;
+            if (hit && *hit <= delta_time) {
+                unit.position = unit.position + unit.velocity * (*hit);
+                return { obstacle };
+            }
         }
-    }
 
-    if (!has_collision) {
-        unit.next_position = unit.position + unit.velocity * delta_time;
+        unit.position = unit.position + unit.velocity * delta_time;
     }
 
-    unit.position = unit.next_position;
-    return SimulateEnemyMovement(unit, obstacles, cur_tick + 1);
+    return std::nullopt;
 }
 
-int Simulator::Simulate(
-        model::Unit& unit, model::UnitOrder& order,
-        std::vector<model::Projectile>& bullets,
-        const std::vector<const model::Obstacle*>& obstacles,
-        const model::Zone& zone,
-        int cur_tick) const {
-    if (cur_tick - started_tick >= SIMULATED_TICKS)  {
-        return 0;
-    }
-
-    int damage = 0;
+void Simulator::SimulateEnemyMovement(model::Unit& unit, int cur_tick) {
+    for (; cur_tick - started_tick < simulated_ticks; ++cur_tick) {
+        bool has_collision = false;
+        for (auto& obstacle : obstaclesInReach(unit)) {
+            auto hit = unit.hasHit(*obstacle);
+
+            if (hit && *hit <= delta_time) {
+                has_collision = true;
+                double f1_time = *hit;
+                double f2_time = delta_time - f1_time;
+                unit.next_position = unit.position + unit.velocity * f1_time;
+                auto v = (obstacle->position - unit.next_position).norm();
+                unit.velocity = model::Vec2(-v.y, v.x) * (v.cross(unit.velocity) / unit.velocity.len());
+                unit.next_position += unit.velocity * f2_time;
+                break;
+            }
+        }
 
-    // SIMULATE UNIT AIM
-    if (unit.weapon && order.action && std::holds_alternative<model::Aim>(*order.action)) {
-        unit.aim += delta_time / constants.weapons[*unit.weapon].aimTime;
-    } else {
-        unit.aim -= delta_time / constants.weapons[*unit.weapon].aimTime;
-    }
-    unit.aim = std::clamp(unit.aim, 0.0, 1.0);
+        if (!has_collision) {
+            unit.next_position = unit.position + unit.velocity * delta_time;
+        }
 
-    // SIMULATE UNIT ROTATION
-    double diff_angle = atan2(order.targetDirection.cross(unit.direction), order.targetDirection.dot(unit.direction)) * 180 / M_PI;
-    double aim_rotation_speed = unit.weapon ? constants.weapons[*unit.weapon].aimRotationSpeed : 0;
-    double rotation_speed = constants.rotationSpeed - (constants.rotationSpeed - aim_rotation_speed) * unit.aim;
-    double sign = diff_angle > 0 ? -1 : 1;
-
-    double angle_shift = sign * std::min(fabs(diff_angle), rotation_speed * delta_time) * M_PI / 180;
-    unit.direction.rotate(angle_shift);
-
-    // SIMULATE UNIT SHOOTING
-    if (std::holds_alternative<model::Aim>(*order.action) && std::get<model::Aim>(*order.action).shoot && 1.0 - unit.aim < 1e-6 && unit.nextShotTick <= cur_tick) {
-        // bool has_hit = false;
-        // auto bullet_ray = model::Ray(unit.position, unit.direction);
-        // for (auto& enemy : enemies) {
-        //     has_hit = has_hit || bullet_ray.intersectsCircle(enemy.position, constants.unitRadius);
-        // }
-        // if (has_hit) {
-        unit.nextShotTick = 1e9;
-        //cur_tick + ceil(1 / constants.weapons[*unit.weapon].roundsPerSecond * constants.ticksPerSecond);
-        damage -= constants.weapons[*unit.weapon].projectileDamage / 2;
-        // }
+        unit.position = unit.next_position;
     }
+}
 
-    // SIMULATE UNIT MOVEMENT
-    unit.calcSpeedCircle(constants);
-    auto move_dir = order.targetVelocity.clone().norm();
-    auto max_velocity_len = unit.getVelocity(move_dir).len();
-    model::Vec2 target_velocity;
-    if (max_velocity_len >= order.targetVelocity.len()) {
-        target_velocity = order.targetVelocity;
-    } else {
-        target_velocity = move_dir.mul(max_velocity_len);
-    }
+int Simulator::Simulate(
+        model::Unit& unit, const model::UnitOrder& order,
+        const ProjectileBatch& bullets,
+        const model::Zone& zone) {
+    return Simulate(unit, Plan(order), bullets, zone);
+}
 
-    auto velocity_shift = (target_velocity - unit.velocity);
-    if (velocity_shift.len() > constants.unitAcceleration * delta_time) {
-        velocity_shift.norm().mul(constants.unitAcceleration * delta_time);
-    }
-    unit.velocity += velocity_shift;
+int Simulator::Simulate(
+        model::Unit& unit, const Plan& plan,
+        const ProjectileBatch& bullets,
+        const model::Zone& zone) {
+    field_scratch.build(bullets, *obstacle_grid, simulated_ticks, delta_time);
+    return Simulate(unit, plan, field_scratch, zone);
+}
 
-    bool has_collision = false;
-    for (auto& obstacle : obstacles) {
-        auto hit = unit.hasHit(*obstacle);
-
-        if (hit && *hit <= delta_time) {
-            has_collision = true;
-            double f1_time = *hit;
-            double f2_time = delta_time - f1_time;
-            unit.next_position = unit.position + unit.velocity * f1_time;
-            auto v = (obstacle->position - unit.next_position).norm();
-            unit.velocity = model::Vec2(-v.y, v.x) * (v.cross(unit.velocity) / unit.velocity.len());
-            unit.next_position += unit.velocity * f2_time;
-            break;
+template<typename T>
+int Simulator::Simulate(
+        model::Unit& unit, const Plan& plan,
+        const BulletFieldT<T>& field,
+        const model::Zone& zone,
+        const DangerMap* danger,
+        int bound) {
+    std::vector<T>& unit_hits = hitBuffer<T>();
+    unit_hits.resize(field.paddedSize());
+    // Projectiles that already hit the unit in this rollout, by field index
+    hit_unit.assign(field.size(), false);
+    skipped_ticks = 0;
+    shot_credit = 0;
+
+    // The only damage that can be taken back later is the bonus of the one shot a rollout allows
+    int last_shot_segment = -1;
+    for (size_t k = 0; k < plan.segments.size(); ++k) {
+        if (wantsShot(plan.segments[k].order)) {
+            last_shot_segment = k;
         }
     }
+    double shot_bonus = unit.weapon ? constants.weapons[*unit.weapon].projectileDamage / 2 : 0;
+    bool shot = false;
+
+    size_t segment = 0;
+    const model::UnitOrder* order = &plan.segments[0].order;
+    long long segment_end = plan.segments[0].ticks;
+    bool wants_shot = wantsShot(*order);
+    Motion motion = beginMotion(unit, *order);
+    int total_damage = 0;
+    ++rollouts;
+
+    for (int tick = 0; tick < simulated_ticks; ++tick) {
+        int cur_tick = started_tick + tick;
+        int damage = 0;
+
+        if (tick == segment_end && segment + 1 < plan.segments.size()) {
+            ++segment;
+            order = &plan.segments[segment].order;
+            segment_end += plan.segments[segment].ticks;
+            wants_shot = wantsShot(*order);
+            motion = beginMotion(unit, *order);
+        }
 
-    if (!has_collision) {
-        unit.next_position = unit.position + unit.velocity * delta_time;
-    }
+        simulateRotation(unit, motion);
 
-    // SIMULATE BULLETS MOVEMENT
-    for (auto& bullet : bullets) {
-        if (bullet.destroyed) {
-            continue;
+        // SIMULATE UNIT SHOOTING
+        if (wants_shot && 1.0 - unit.aim < 1e-6 && unit.nextShotTick <= cur_tick) {
+            unit.nextShotTick = 1e9;
+            shot = true;
+            shot_credit = constants.weapons[*unit.weapon].projectileDamage / 2;
+            damage -= shot_credit;
         }
 
-        std::optional<model::Vec2> obstacle_hit;
-        double obstacle_min_dist = 1e9;
-        for (auto& obstacle : obstacles) {
-            if (obstacle->canShootThrough) {
-                continue;
-            }
-            if ((bullet.position.distTo(obstacle->position) - obstacle->radius) / constants.weapons[bullet.weaponTypeIndex].projectileSpeed > delta_time) {
-                continue;
-            }
-            auto hit = bullet.hasHit(*obstacle);
-            if (!hit) {
-                continue;
-            }
-            double dist = bullet.position.distTo(*hit);
-            if (dist < obstacle_min_dist) {
-                obstacle_min_dist = dist;
-                obstacle_hit = hit;
+        // SIMULATE UNIT MOVEMENT
+        simulateVelocity(unit, *order, motion);
+
+        bool has_collision = false;
+        for (auto& obstacle : obstaclesInReach(unit)) {
+            auto hit = unit.hasHit(*obstacle);
+
+            if (hit && *hit <= delta_time) {
+                has_collision = true;
+                double f1_time = *hit;
+                double f2_time = delta_time - f1_time;
+                unit.next_position = unit.position + unit.velocity * f1_time;
+                auto v = (obstacle->position - unit.next_position).norm();
+                unit.velocity = model::Vec2(-v.y, v.x) * (v.cross(unit.velocity) / unit.velocity.len());
+                unit.next_position += unit.velocity * f2_time;
+                break;
             }
         }
 
-        auto unit_hit = bullet.hasHit(unit);
-
-        if (!unit_hit && obstacle_hit) {
-            bullet.destroyed = true;
-            continue;
+        if (!has_collision) {
+            unit.next_position = unit.position + unit.velocity * delta_time;
         }
 
-        if (unit_hit && !obstacle_hit) {
-            // std::cerr << "HAS HIT! +" << constants.weapons[bullet.weaponTypeIndex].projectileDamage << " damage\n";
-            damage += constants.weapons[bullet.weaponTypeIndex].projectileDamage;
-            bullet.destroyed = true;
-            continue;
-        }
-
-        if (unit_hit && obstacle_hit) {
-            // std::cerr << "HAS HIT! +" << constants.weapons[bullet.weaponTypeIndex].projectileDamage << " damage\n";
-            if (obstacle_min_dist > bullet.position.distTo(unit.position) - constants.unitRadius) {
-                damage += constants.weapons[bullet.weaponTypeIndex].projectileDamage;
+        // BULLETS HITTING THE UNIT, the field already moved them and stopped them at obstacles.
+        // Nothing to test where the danger map proves that no bullet can reach.
+        const ProjectileBatchT<T>& batch = field.frame(tick);
+        if (!danger || danger->mayHit(unit.position, tick, unit.velocity.len() * delta_time)) {
+            const T* obstacle_hits = field.obstacleHits(tick);
+            simulated_bullets += batch.size();
+            batch.sweptCircleHits(model::Vec2T<T>(unit.position), model::Vec2T<T>(unit.velocity), T(unit.unit_radius_sq), T(delta_time), unit_hits.data(), false);
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (unit_hits[i] == ProjectileBatchT<T>::NO_HIT || hit_unit[i]) {
+                    continue;
+                }
+                hit_unit[i] = true;
+
+                if (obstacle_hits[i] == ProjectileBatchT<T>::NO_HIT) {
+                    damage += batch.damage[i];
+                    continue;
+                }
+
+                model::Vec2 position(batch.x[i], batch.y[i]);
+                model::Vec2 velocity(batch.vx[i], batch.vy[i]);
+                double obstacle_min_dist = position.distTo(position + velocity * obstacle_hits[i]);
+                if (obstacle_min_dist > position.distTo(unit.position) - constants.unitRadius) {
+                    damage += batch.damage[i];
+                }
             }
-            bullet.destroyed = true;
-            continue;
         }
 
-        if (bullet.lifeTime <= delta_time) {
-            bullet.destroyed = true;
-            continue;
-        }
+        unit.position = unit.next_position;
+        trajectory[tick] = unit.position;
 
-        bullet.position += bullet.velocity * delta_time;
-        bullet.lifeTime -= delta_time;
-    }
+        if (zone.currentCenter.distTo(unit.position) + constants.unitRadius >= zone.currentRadius) {
+            damage += 2;
+        }
 
-    unit.position = unit.next_position;
+        tick_damage[tick] = damage;
+        total_damage += damage;
 
-    if (zone.currentCenter.distTo(unit.position) + constants.unitRadius >= zone.currentRadius) {
-        damage += 2;
+        bool bonus_ahead = !shot && (int)segment <= last_shot_segment;
+        if (total_damage - (bonus_ahead ? shot_bonus : 0) > bound) {
+            skipped_ticks = simulated_ticks - tick - 1;
+            pruned_ticks += skipped_ticks;
+            break;
+        }
     }
 
-    damage += Simulate(unit, order, bullets, obstacles, zone, cur_tick + 1);
-
-    return damage;
+    return total_damage;
 }
+
+template int Simulator::Simulate(model::Unit&, const Plan&, const BulletFieldT<double>&, const model::Zone&, const DangerMap*, int);
+template int Simulator::Simulate(model::Unit&, const Plan&, const BulletFieldT<float>&, const model::Zone&, const DangerMap*, int);
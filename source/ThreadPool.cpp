@@ -0,0 +1,84 @@
+#include "ThreadPool.hpp"
+
+namespace {
+    thread_local bool in_pool_task = false;
+    thread_local size_t current_worker = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    for (size_t worker = 1; worker < threads; ++worker) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::currentWorker() {
+    return current_worker;
+}
+
+void ThreadPool::parallelFor(size_t count, const Task& fn) {
+    if (workers.empty() || count <= 1 || in_pool_task) {
+        for (size_t index = 0; index < count; ++index) {
+            fn(current_worker, index);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        task_count = count;
+        next_index = 0;
+        active = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    in_pool_task = true;
+    runTasks(0);
+    in_pool_task = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return active == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::runTasks(size_t worker) {
+    size_t index;
+    while ((index = next_index.fetch_add(1)) < task_count) {
+        (*task)(worker, index);
+    }
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    in_pool_task = true;
+    current_worker = worker;
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        runTasks(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--active == 0) {
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#include "stream/BufferStream.hpp"
+#include <algorithm>
+
+BufferStream::BufferStream(size_t capacity)
+    : buffer(std::max<size_t>(capacity, 1))
+{
+    writePos = buffer.data();
+    writeEnd = buffer.data() + buffer.size();
+}
+
+void BufferStream::flush()
+{
+}
+
+void BufferStream::truncate(size_t size)
+{
+    writePos = buffer.data() + std::min(size, this->size());
+}
+
+void BufferStream::overflow(const char* bytes, size_t byteCount)
+{
+    size_t used = size();
+    buffer.resize(std::max(used + byteCount, 2 * buffer.size()));
+    std::memcpy(buffer.data() + used, bytes, byteCount);
+    writePos = buffer.data() + used + byteCount;
+    writeEnd = buffer.data() + buffer.size();
+}
@@ -0,0 +1,27 @@
+#ifndef __BUFFER_STREAM_HPP__
+#define __BUFFER_STREAM_HPP__
+
+#include "stream/Stream.hpp"
+#include <vector>
+
+// Output stream collecting everything in memory. Clearing keeps the capacity,
+// so a long-lived buffer stops allocating once it has seen its largest batch.
+class BufferStream : public OutputStream {
+public:
+    BufferStream(size_t capacity = 4 * 1024);
+    void flush();
+
+    const char* data() const { return buffer.data(); }
+    size_t size() const { return writePos - buffer.data(); }
+    void clear() { writePos = buffer.data(); }
+    // Drop everything written after the first size bytes
+    void truncate(size_t size);
+
+protected:
+    void overflow(const char* bytes, size_t byteCount);
+
+private:
+    std::vector<char> buffer;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "stream/RecordingStream.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+RecordingStream::RecordingStream(InputStream& source, const std::string& path)
+    : source(source)
+    , file(path, std::ios::binary | std::ios::trunc)
+    , buffer(4 * 1024)
+{
+    if (!file) {
+        throw std::runtime_error("Failed to open recording file " + path);
+    }
+    readPos = readEnd = buffer.data();
+}
+
+RecordingStream::~RecordingStream()
+{
+    file.flush();
+}
+
+void RecordingStream::fill(size_t byteCount)
+{
+    size_t unread = readEnd - readPos;
+    memmove(buffer.data(), readPos, unread);
+    if (buffer.size() < byteCount) {
+        buffer.resize(std::max(byteCount, 2 * buffer.size()));
+    }
+    source.readBytes(buffer.data() + unread, byteCount - unread);
+    file.write(buffer.data() + unread, byteCount - unread);
+    readPos = buffer.data();
+    readEnd = buffer.data() + byteCount;
+}
+
+void RecordingStream::flush()
+{
+    file.flush();
+}
@@ -0,0 +1,28 @@
+#ifndef __RECORDING_STREAM_HPP__
+#define __RECORDING_STREAM_HPP__
+
+#include "stream/Stream.hpp"
+#include <fstream>
+#include <vector>
+
+// Input stream passing everything read from another stream through to a file,
+// the file can be played back later with ReplayStream
+class RecordingStream : public InputStream {
+public:
+    RecordingStream(InputStream& source, const std::string& path);
+    ~RecordingStream();
+    // Push recorded bytes to disk
+    void flush();
+
+protected:
+    // Takes exactly the missing bytes from the source, so it never waits for data
+    // the server has not sent yet
+    void fill(size_t byteCount);
+
+private:
+    InputStream& source;
+    std::ofstream file;
+    std::vector<char> buffer;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "stream/ReplayStream.hpp"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+ReplayStream::ReplayStream(const std::string& path)
+    : writeBuffer(64 * 1024)
+    , writtenSize(0)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open replay file " + path);
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    // The whole recording is one read window
+    readPos = data.data();
+    readEnd = data.data() + data.size();
+    writePos = writeBuffer.data();
+    writeEnd = writeBuffer.data() + writeBuffer.size();
+}
+
+void ReplayStream::fill(size_t /*byteCount*/)
+{
+    throw std::runtime_error("Unexpected end of replay");
+}
+
+void ReplayStream::overflow(const char* /*buffer*/, size_t byteCount)
+{
+    flush();
+    writtenSize += byteCount;
+}
+
+void ReplayStream::flush()
+{
+    writtenSize += writePos - writeBuffer.data();
+    writePos = writeBuffer.data();
+}
+
+bool ReplayStream::atEnd() const
+{
+    return readPos == readEnd;
+}
+
+size_t ReplayStream::bytesWritten() const
+{
+    return writtenSize + (writePos - writeBuffer.data());
+}
@@ -0,0 +1,27 @@
+#ifndef __REPLAY_STREAM_HPP__
+#define __REPLAY_STREAM_HPP__
+
+#include "stream/Stream.hpp"
+#include <vector>
+
+// Server side of a game recorded by RecordingStream. Reads come from the file,
+// writes are counted and dropped.
+class ReplayStream : public InputStream, public OutputStream {
+public:
+    ReplayStream(const std::string& path);
+    void flush();
+    // Whether the whole recording has been read
+    bool atEnd() const;
+    size_t bytesWritten() const;
+
+protected:
+    void fill(size_t byteCount);
+    void overflow(const char* buffer, size_t byteCount);
+
+private:
+    std::vector<char> data;
+    std::vector<char> writeBuffer;
+    size_t writtenSize;
+};
+
+#endif
@@ -1,46 +1,135 @@
 #ifndef __STREAM_HPP__
 #define __STREAM_HPP__
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
-// Input stream interface
+// Wire format is little endian, only big endian machines need to swap bytes
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define STREAM_SWAP_BYTES 1
+#else
+#define STREAM_SWAP_BYTES 0
+#endif
+
+// Input stream interface. Reads are served from a buffer window provided by the
+// implementation, which is only called when the window runs dry.
 class InputStream {
 public:
+    virtual ~InputStream() = default;
     // Read exactly byteCount bytes into buffer
-    virtual void readBytes(char* buffer, size_t byteCount) = 0;
+    void readBytes(char* buffer, size_t byteCount)
+    {
+        if ((size_t)(readEnd - readPos) < byteCount) {
+            fill(byteCount);
+        }
+        std::memcpy(buffer, readPos, byteCount);
+        readPos += byteCount;
+    }
+    // Read count values of a plain type stored back to back
+    template <typename T>
+    void readArray(T* values, size_t count)
+    {
+        readBytes(reinterpret_cast<char*>(values), sizeof(T) * count);
+#if STREAM_SWAP_BYTES
+        for (size_t i = 0; i < count; ++i) {
+            char* bytes = reinterpret_cast<char*>(values + i);
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+#endif
+    }
     // Read a bool from this stream
-    bool readBool();
+    bool readBool()
+    {
+        char value;
+        readBytes(&value, 1);
+        return value != 0;
+    }
     // Read an int from this stream
-    int readInt();
+    int readInt() { return read<int>(); }
     // Read a long long from this stream
-    long long readLongLong();
+    long long readLongLong() { return read<long long>(); }
     // Read a float from this stream
-    float readFloat();
+    float readFloat() { return read<float>(); }
     // Read a double from this stream
-    double readDouble();
+    double readDouble() { return read<double>(); }
     // Read a string from this stream
     std::string readString();
+
+protected:
+    // Make at least byteCount unread bytes available in [readPos, readEnd),
+    // keeping the ones not consumed yet
+    virtual void fill(size_t byteCount) = 0;
+
+    const char* readPos = nullptr;
+    const char* readEnd = nullptr;
+
+private:
+    template <typename T>
+    T read()
+    {
+        T value;
+        readArray(&value, 1);
+        return value;
+    }
 };
 
-// Output stream interface
+// Output stream interface. Writes go to a buffer window provided by the
+// implementation, which is only called when a write does not fit.
 class OutputStream {
 public:
+    virtual ~OutputStream() = default;
     // Write byte buffer into this stream
-    virtual void writeBytes(const char* buffer, size_t byteCount) = 0;
+    void writeBytes(const char* buffer, size_t byteCount)
+    {
+        if ((size_t)(writeEnd - writePos) < byteCount) {
+            overflow(buffer, byteCount);
+            return;
+        }
+        std::memcpy(writePos, buffer, byteCount);
+        writePos += byteCount;
+    }
+    // Write count values of a plain type back to back
+    template <typename T>
+    void writeArray(const T* values, size_t count)
+    {
+#if STREAM_SWAP_BYTES
+        for (size_t i = 0; i < count; ++i) {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, values + i, sizeof(T));
+            std::reverse(bytes, bytes + sizeof(T));
+            writeBytes(bytes, sizeof(T));
+        }
+#else
+        writeBytes(reinterpret_cast<const char*>(values), sizeof(T) * count);
+#endif
+    }
     // Flush this stream
     virtual void flush() = 0;
     // Write a bool into this stream
-    void write(bool value);
+    void write(bool value)
+    {
+        char byte = value;
+        writeBytes(&byte, 1);
+    }
     // Write an int into this stream
-    void write(int value);
+    void write(int value) { writeArray(&value, 1); }
     // Write a long long into this stream
-    void write(long long value);
+    void write(long long value) { writeArray(&value, 1); }
     // Write a float into this stream
-    void write(float value);
+    void write(float value) { writeArray(&value, 1); }
     // Write a double into this stream
-    void write(double value);
+    void write(double value) { writeArray(&value, 1); }
     // Write a string into this stream
     void write(const std::string& value);
+
+protected:
+    // Take buffer when it does not fit into [writePos, writeEnd), passing on
+    // whatever is buffered before it
+    virtual void overflow(const char* buffer, size_t byteCount) = 0;
+
+    char* writePos = nullptr;
+    char* writeEnd = nullptr;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,12 +1,12 @@
 #include "stream/TcpStream.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <stdexcept>
 
-TcpStream::TcpStream(const std::string& host, int port)
-    : readBufferPos(0)
-    , readBufferSize(0)
-    , writeBufferPos(0)
-    , writeBufferSize(0)
+TcpStream::TcpStream(const std::string& host, int port, size_t bufferCapacity)
+    : readBuffer(std::max<size_t>(bufferCapacity, 1))
+    , writeBuffer(std::max<size_t>(bufferCapacity, 1))
 {
 #ifdef _WIN32
     WSADATA wsa_data;
@@ -35,33 +35,66 @@ TcpStream::TcpStream(const std::string& host, int port)
         throw std::runtime_error("Failed to connect");
     }
     freeaddrinfo(servinfo);
+    readPos = readEnd = readBuffer.data();
+    writePos = writeBuffer.data();
+    writeEnd = writeBuffer.data() + writeBuffer.size();
 }
 
-void TcpStream::readBytes(char* buffer, size_t byteCount)
+size_t TcpStream::receive(char* buffer, size_t capacity, bool wait)
 {
-    while (byteCount > 0) {
-        if (readBufferSize > 0) {
-            if (readBufferSize >= byteCount) {
-                memcpy(buffer, this->readBuffer + readBufferPos, byteCount);
-                readBufferPos += byteCount;
-                readBufferSize -= byteCount;
-                return;
+#ifdef MSG_DONTWAIT
+    int flags = wait ? 0 : MSG_DONTWAIT;
+#else
+    int flags = 0;
+    if (!wait) {
+        return 0;
+    }
+#endif
+    ++ioStats.recvCalls;
+    RECV_SEND_T received = recv(sock, buffer, capacity, flags);
+    if (received > 0) {
+        ioStats.bytesReceived += received;
+        return received;
+    }
+    if (!wait && received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return 0;
+    }
+    throw std::runtime_error("Failed to read from socket");
+}
+
+void TcpStream::fill(size_t byteCount)
+{
+    size_t unread = readEnd - readPos;
+    memmove(readBuffer.data(), readPos, unread);
+    if (readBuffer.size() < byteCount) {
+        readBuffer.resize(std::max(byteCount, 2 * readBuffer.size()));
+    }
+    while (unread < byteCount) {
+        unread += receive(readBuffer.data() + unread, readBuffer.size() - unread, true);
+    }
+    while (frameReads) {
+        if (unread == readBuffer.size()) {
+            if (readBuffer.size() >= MAX_BUFFER_CAPACITY) {
+                break;
             }
-            memcpy(buffer, this->readBuffer + readBufferPos, readBufferSize);
-            buffer += readBufferSize;
-            byteCount -= readBufferSize;
-            readBufferPos += readBufferSize;
-            readBufferSize = 0;
-        }
-        if (readBufferPos == BUFFER_CAPACITY) {
-            readBufferPos = 0;
+            readBuffer.resize(2 * readBuffer.size());
         }
-        RECV_SEND_T received = recv(sock, this->readBuffer + readBufferPos + readBufferSize,
-            BUFFER_CAPACITY - readBufferPos - readBufferSize, 0);
-        if (received < 0) {
-            throw std::runtime_error("Failed to read from socket");
+        size_t received = receive(readBuffer.data() + unread, readBuffer.size() - unread, false);
+        if (received == 0) {
+            break;
         }
-        readBufferSize += received;
+        unread += received;
+    }
+    readPos = readBuffer.data();
+    readEnd = readBuffer.data() + unread;
+
+    // Filled up: the messages are bigger than the buffer, make the next refill cheaper
+    if (unread == readBuffer.size() && readBuffer.size() < MAX_BUFFER_CAPACITY) {
+        std::vector<char> grown(2 * readBuffer.size());
+        memcpy(grown.data(), readBuffer.data(), unread);
+        readBuffer.swap(grown);
+        readPos = readBuffer.data();
+        readEnd = readBuffer.data() + unread;
     }
 }
 
@@ -77,32 +110,59 @@ TcpStream::~TcpStream()
     }
 }
 
-void TcpStream::writeBytes(const char* buffer, size_t byteCount)
+void TcpStream::sendAll(const char* buffer, size_t byteCount)
 {
     while (byteCount > 0) {
-        size_t capacity = BUFFER_CAPACITY - writeBufferPos - writeBufferSize;
-        if (capacity >= byteCount) {
-            memcpy(this->writeBuffer + writeBufferPos + writeBufferSize, buffer, byteCount);
-            writeBufferSize += byteCount;
-            return;
+        ++ioStats.sendCalls;
+        RECV_SEND_T sent = send(sock, buffer, byteCount, 0);
+        if (sent < 0) {
+            throw std::runtime_error("Failed to write to socket");
         }
-        memcpy(this->writeBuffer + writeBufferPos + writeBufferSize, buffer, capacity);
-        writeBufferSize += capacity;
-        byteCount -= capacity;
-        buffer += capacity;
-        flush();
+        ioStats.bytesSent += sent;
+        buffer += sent;
+        byteCount -= sent;
     }
 }
 
-void TcpStream::flush()
+void TcpStream::sendAll(const char* first, size_t firstCount, const char* second, size_t secondCount)
 {
-    while (writeBufferSize > 0) {
-        RECV_SEND_T sent = send(sock, writeBuffer + writeBufferPos, writeBufferSize, 0);
+#ifdef _WIN32
+    sendAll(first, firstCount);
+    sendAll(second, secondCount);
+#else
+    while (firstCount > 0) {
+        iovec parts[2] = { { (void*)first, firstCount }, { (void*)second, secondCount } };
+        ++ioStats.sendCalls;
+        ssize_t sent = writev(sock, parts, 2);
         if (sent < 0) {
             throw std::runtime_error("Failed to write to socket");
         }
-        writeBufferPos += sent;
-        writeBufferSize -= sent;
+        ioStats.bytesSent += sent;
+        size_t fromFirst = std::min((size_t)sent, firstCount);
+        first += fromFirst;
+        firstCount -= fromFirst;
+        second += sent - fromFirst;
+        secondCount -= sent - fromFirst;
     }
-    writeBufferPos = 0;
-}
\ No newline at end of file
+    sendAll(second, secondCount);
+#endif
+}
+
+void TcpStream::overflow(const char* buffer, size_t byteCount)
+{
+    if (byteCount < writeBuffer.size() / 2) {
+        flush();
+        memcpy(writePos, buffer, byteCount);
+        writePos += byteCount;
+        return;
+    }
+    // Large write: buffered bytes and the payload leave in one gather write
+    sendAll(writeBuffer.data(), writePos - writeBuffer.data(), buffer, byteCount);
+    writePos = writeBuffer.data();
+}
+
+void TcpStream::flush()
+{
+    sendAll(writeBuffer.data(), writePos - writeBuffer.data());
+    writePos = writeBuffer.data();
+}
@@ -2,6 +2,7 @@
 #define __TCP_STREAM_HPP__
 
 #include "stream/Stream.hpp"
+#include <vector>
 
 #ifdef _WIN32
 #ifndef _WIN32_WINNT
@@ -11,6 +12,7 @@
 #include <winsock2.h>
 typedef int RECV_SEND_T;
 #else
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
@@ -22,21 +24,46 @@ typedef ssize_t RECV_SEND_T;
 
 class TcpStream : public InputStream, public OutputStream {
 public:
-    TcpStream(const std::string& host, int port);
+    static const size_t BUFFER_CAPACITY = 8 * 1024;
+
+    // Socket syscalls and bytes moved, only ever growing
+    struct Stats {
+        long long recvCalls = 0;
+        long long sendCalls = 0;
+        long long bytesReceived = 0;
+        long long bytesSent = 0;
+    };
+
+    TcpStream(const std::string& host, int port, size_t bufferCapacity = BUFFER_CAPACITY);
     ~TcpStream();
-    void readBytes(char* buffer, size_t byteCount);
-    void writeBytes(const char* buffer, size_t byteCount);
     void flush();
 
+    // Keep reading whatever the server has already sent after a read is satisfied,
+    // so a whole message usually arrives in one refill
+    void setFrameReads(bool enabled) { frameReads = enabled; }
+    const Stats& stats() const { return ioStats; }
+
+protected:
+    // Messages are parsed field by field and no single read is more than a few dozen
+    // bytes, so refills go to the read buffer only: a scatter read into the caller's
+    // buffer would never get a payload large enough to bypass it
+    void fill(size_t byteCount);
+    void overflow(const char* buffer, size_t byteCount);
+
 private:
+    static const size_t MAX_BUFFER_CAPACITY = 16 * 1024 * 1024;
+
+    void sendAll(const char* buffer, size_t byteCount);
+    void sendAll(const char* first, size_t firstCount, const char* second, size_t secondCount);
+    size_t receive(char* buffer, size_t capacity, bool wait);
+
     SOCKET sock;
-    static const size_t BUFFER_CAPACITY = 8 * 1024;
-    char readBuffer[BUFFER_CAPACITY];
-    size_t readBufferPos;
-    size_t readBufferSize;
-    char writeBuffer[BUFFER_CAPACITY];
-    size_t writeBufferPos;
-    size_t writeBufferSize;
+    bool frameReads = false;
+    Stats ioStats;
+    // The read buffer doubles whenever a refill fills it up, the write buffer stays
+    // as configured and larger writes bypass it
+    std::vector<char> readBuffer;
+    std::vector<char> writeBuffer;
 };
 
 #endif
\ No newline at end of file
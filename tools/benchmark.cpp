@@ -0,0 +1,266 @@
+#include "MyStrategy.hpp"
+#include "Simulator.hpp"
+#include "ObstacleGrid.hpp"
+#include "ProjectileBatch.hpp"
+#include "BulletField.hpp"
+#include "model/Ray.hpp"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Micro-benchmarks of the simulator and geometry hot path on synthetic seeded scenes.
+// Usage: benchmark [--seed N] [--min-time-ms T] [--filter substring] [--bullets N] [--obstacles N]
+// Prints one JSON document with ns/op and ops/sec per benchmark.
+
+namespace {
+
+const int SCENES = 64;
+
+struct Settings {
+    unsigned seed = 42;
+    double min_time_ms = 300;
+    std::string filter;
+    int bullets = 60;
+    int obstacles = 400;
+};
+
+struct Result {
+    std::string name;
+    long long ops;
+    double ns_per_op;
+};
+
+// Keeps results alive so the optimizer can not drop the measured calls
+volatile double sink;
+
+model::Constants makeConstants(std::mt19937& rng, const Settings& settings) {
+    std::vector<model::WeaponProperties> weapons = {
+        model::WeaponProperties("Magic wand", 2, 5, 0.2, 60, 180, 0.8, 30, 20, 1.0, std::nullopt, std::nullopt, 30),
+        model::WeaponProperties("Staff", 5, 5, 0.5, 60, 90, 0.5, 20, 30, 0.6, std::nullopt, std::nullopt, 100),
+        model::WeaponProperties("Bow", 0.8, 0.5, 1.5, 15, 45, 0.4, 50, 50, 1.8, std::nullopt, std::nullopt, 20),
+    };
+    std::vector<model::Obstacle> obstacles;
+    std::uniform_real_distribution<double> pos(-150, 150), radius(1, 5);
+    for (int i = 0; i < settings.obstacles; ++i) {
+        obstacles.emplace_back(i, model::Vec2(pos(rng), pos(rng)), radius(rng), i % 3 == 0, i % 4 == 0);
+    }
+    return model::Constants(30, 5, 300, 1, 5, 1, 10, 1, 0, 1, 100, 5, 10, 100, 0, 2, 50, 90, 60, true, 90, 10, 10, 5, 30,
+        false, 1, 1, 1, weapons, 0, 10, 10, 50, 1, {}, std::nullopt, 5, obstacles);
+}
+
+// Late game: small zone, units near its edge, plenty of bullets flying around them
+struct Scene {
+    model::Unit unit;
+    model::UnitOrder order;
+    model::Zone zone;
+    std::vector<model::Projectile> bullets;
+    ProjectileBatch batch;
+    BulletField field;
+    BulletFieldT<float> field_float;
+};
+
+std::vector<Scene> makeScenes(std::mt19937& rng, const model::Constants& constants, const Settings& settings) {
+    std::uniform_real_distribution<double> u(0, 1), angle(0, 2 * M_PI), offset(-15, 15);
+    std::vector<Scene> scenes;
+    for (int s = 0; s < SCENES; ++s) {
+        double zone_radius = 10 + 20 * u(rng);
+        model::Zone zone(model::Vec2(offset(rng), offset(rng)), zone_radius, model::Vec2(0, 0), zone_radius);
+        double a = angle(rng), b = angle(rng), c = angle(rng);
+        auto position = zone.currentCenter + model::Vec2(cos(a), sin(a)) * (zone_radius * u(rng));
+        int weapon = (int)(u(rng) * 3);
+        model::Unit unit(1, 0, 100, 50, 1, position, std::nullopt, model::Vec2(cos(b), sin(b)) * 5, model::Vec2(cos(c), sin(c)),
+            u(rng), std::nullopt, 0, weapon, 0, {10, 50, 10}, 1);
+        unit.unit_radius_sq = constants.unitRadius * constants.unitRadius;
+        unit.calcSpeedCircle(constants);
+
+        double d = angle(rng);
+        model::UnitOrder order(model::Vec2(cos(d), sin(d)) * 10, model::Vec2(cos(a), sin(a)),
+            u(rng) < 0.5 ? std::optional<model::ActionOrder>(model::Aim(true)) : std::nullopt);
+
+        std::vector<model::Projectile> bullets;
+        for (int k = 0; k < settings.bullets; ++k) {
+            int w = (int)(u(rng) * 3);
+            double e = angle(rng);
+            auto& props = constants.weapons[w];
+            auto from = position + model::Vec2(offset(rng), offset(rng)) * 2;
+            // Half of them aimed at the unit
+            auto dir = k % 2 == 0 ? (position - from).norm() : model::Vec2(cos(e), sin(e));
+            bullets.emplace_back(100 + k, w, 2, 1, from, dir * props.projectileSpeed, props.projectileLifeTime * u(rng));
+        }
+        ProjectileBatch batch;
+        batch.assign(bullets, constants);
+        scenes.push_back({ unit, order, zone, bullets, batch, BulletField(), BulletFieldT<float>() });
+    }
+    return scenes;
+}
+
+// Runs body(i) for growing batches until min_time_ms of wall time is spent.
+// Each call of body counts as ops_per_call operations.
+Result measure(const std::string& name, long long ops_per_call, const Settings& settings, const std::function<void(size_t)>& body) {
+    typedef std::chrono::steady_clock Clock;
+    for (size_t i = 0; i < SCENES; ++i) {
+        body(i);
+    }
+
+    long long calls = 0;
+    long long batch = 1;
+    double elapsed_ns = 0;
+    while (elapsed_ns < settings.min_time_ms * 1e6) {
+        auto start = Clock::now();
+        for (long long k = 0; k < batch; ++k) {
+            body((calls + k) % SCENES);
+        }
+        elapsed_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        calls += batch;
+        batch *= 2;
+    }
+    return { name, calls * ops_per_call, elapsed_ns / (calls * ops_per_call) };
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            settings.seed = atoi(argv[++i]);
+        } else if (arg == "--min-time-ms" && i + 1 < argc) {
+            settings.min_time_ms = atof(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            settings.filter = argv[++i];
+        } else if (arg == "--bullets" && i + 1 < argc) {
+            settings.bullets = atoi(argv[++i]);
+        } else if (arg == "--obstacles" && i + 1 < argc) {
+            settings.obstacles = atoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(settings.seed);
+    // The strategy prepares constants (obstacle radius_sq) and publishes them for Projectile::hasHit
+    MyStrategy strategy(makeConstants(rng, settings));
+    const model::Constants& constants = *MyStrategy::getConstants();
+    ObstacleGrid obstacle_grid;
+    obstacle_grid.build(constants.obstacles, ObstacleGrid::DEFAULT_CELL);
+
+    Simulator simulator(constants);
+    simulator.setDeltaTime(1.0 / constants.ticksPerSecond);
+    simulator.obstacle_grid = &obstacle_grid;
+    simulator.started_tick = 0;
+
+    auto scenes = makeScenes(rng, constants, settings);
+    for (auto& scene : scenes) {
+        scene.field.build(scene.batch, obstacle_grid, simulator.simulated_ticks, simulator.delta_time);
+        scene.field_float.build(scene.batch, obstacle_grid, simulator.simulated_ticks, simulator.delta_time);
+    }
+    std::vector<model::Vec2> directions(SCENES);
+    std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+    for (auto& dir : directions) {
+        double a = angle(rng);
+        dir = model::Vec2(cos(a), sin(a));
+    }
+    std::vector<const model::Obstacle*> near_obstacles;
+
+    std::vector<Result> results;
+    auto run = [&](const std::string& name, long long ops_per_call, const std::function<void(size_t)>& body) {
+        if (name.find(settings.filter) != std::string::npos) {
+            results.push_back(measure(name, ops_per_call, settings, body));
+        }
+    };
+
+    run("Simulator::Simulate", 1, [&](size_t i) {
+        auto unit = scenes[i].unit;
+        sink = simulator.Simulate(unit, scenes[i].order, scenes[i].batch, scenes[i].zone);
+    });
+    run("Simulator::Simulate(BulletField)", 1, [&](size_t i) {
+        auto unit = scenes[i].unit;
+        sink = simulator.Simulate(unit, Plan(scenes[i].order), scenes[i].field, scenes[i].zone);
+    });
+    run("Simulator::Simulate(BulletField<float>)", 1, [&](size_t i) {
+        auto unit = scenes[i].unit;
+        sink = simulator.Simulate(unit, Plan(scenes[i].order), scenes[i].field_float, scenes[i].zone);
+    });
+    run("BulletField::build", 1, [&](size_t i) {
+        BulletField& field = scenes[(i + 1) % SCENES].field;
+        field.build(scenes[i].batch, obstacle_grid, simulator.simulated_ticks, simulator.delta_time);
+        sink = field.size();
+    });
+    run("Simulator::SimulateMovement", 1, [&](size_t i) {
+        auto unit = scenes[i].unit;
+        sink = simulator.SimulateMovement(unit, scenes[i].order, 0).has_value();
+    });
+    run("Simulator::SimulateEnemyMovement", 1, [&](size_t i) {
+        auto unit = scenes[i].unit;
+        simulator.SimulateEnemyMovement(unit, 0);
+        sink = unit.position.x;
+    });
+    run("Projectile::hasHit(Unit)", settings.bullets, [&](size_t i) {
+        double acc = 0;
+        for (auto& bullet : scenes[i].bullets) {
+            acc += bullet.hasHit(scenes[i].unit).has_value();
+        }
+        sink = acc;
+    });
+    run("Projectile::hasHit(Obstacle)", settings.bullets, [&](size_t i) {
+        auto& obstacle = constants.obstacles[i % constants.obstacles.size()];
+        double acc = 0;
+        for (auto& bullet : scenes[i].bullets) {
+            acc += bullet.hasHit(obstacle).has_value();
+        }
+        sink = acc;
+    });
+    run("Projectile::getHit(Unit)", settings.bullets, [&](size_t i) {
+        double acc = 0;
+        for (auto& bullet : scenes[i].bullets) {
+            acc += bullet.getHit(scenes[i].unit).has_value();
+        }
+        sink = acc;
+    });
+    run("Projectile::getHit(Obstacle)", settings.bullets, [&](size_t i) {
+        auto& obstacle = constants.obstacles[i % constants.obstacles.size()];
+        double acc = 0;
+        for (auto& bullet : scenes[i].bullets) {
+            acc += bullet.getHit(obstacle).has_value();
+        }
+        sink = acc;
+    });
+    run("Unit::hasHit(nearby obstacles)", 1, [&](size_t i) {
+        obstacle_grid.queryCircle(scenes[i].unit.position, 10, false, near_obstacles);
+        double acc = 0;
+        for (auto obstacle : near_obstacles) {
+            acc += scenes[i].unit.hasHit(*obstacle).has_value();
+        }
+        sink = acc + near_obstacles.size();
+    });
+    run("Unit::getVelocity", 1, [&](size_t i) {
+        sink = scenes[i].unit.getVelocity(directions[i]).x;
+    });
+    run("Ray::intersectsCircle", constants.obstacles.size(), [&](size_t i) {
+        model::Ray ray(scenes[i].unit.position, directions[i]);
+        double acc = 0;
+        for (auto& obstacle : constants.obstacles) {
+            acc += ray.intersectsCircle(obstacle.position, obstacle.radius);
+        }
+        sink = acc;
+    });
+    run("Vec2::rotate", 1, [&](size_t i) {
+        sink = directions[i].clone().rotate(0.1 * i).x;
+    });
+
+    printf("{\n  \"seed\": %u,\n  \"bullets\": %d,\n  \"obstacles\": %d,\n  \"benchmarks\": [\n",
+        settings.seed, settings.bullets, settings.obstacles);
+    for (size_t k = 0; k < results.size(); ++k) {
+        auto& result = results[k];
+        printf("    { \"name\": \"%s\", \"ops\": %lld, \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f }%s\n",
+            result.name.c_str(), result.ops, result.ns_per_op, 1e9 / result.ns_per_op, k + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+    return 0;
+}
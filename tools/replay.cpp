@@ -0,0 +1,174 @@
+#include "MyStrategy.hpp"
+#include "StrategyOptions.hpp"
+#include "stream/ReplayStream.hpp"
+#include "codegame/ServerMessage.hpp"
+#include "codegame/ClientMessage.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace {
+
+// Orders further apart than this in any coordinate count as different
+const double ORDER_TOLERANCE = 1e-3;
+
+std::string actionString(const std::optional<model::ActionOrder>& action) {
+    if (!action) {
+        return "none";
+    }
+    return std::visit([](const auto& order) { return order.toString(); }, *action);
+}
+
+// How far the orders of a float precision strategy drift from the double precision one
+struct Divergence {
+    int ticks = 0;
+    int diverged_ticks = 0;
+    int unit_orders = 0;
+    int diverged_orders = 0;
+    int first_tick = -1;
+    double max_velocity_diff = 0;
+    double max_direction_diff = 0;
+    double reference_ms = 0;
+    double candidate_ms = 0;
+
+    void compare(int tick, const model::Order& reference, const model::Order& candidate) {
+        bool diverged = false;
+        for (auto& [unit_id, order] : reference.unitOrders) {
+            ++unit_orders;
+            auto other = candidate.unitOrders.find(unit_id);
+            if (other == candidate.unitOrders.end()) {
+                ++diverged_orders;
+                diverged = true;
+                continue;
+            }
+            double velocity_diff = order.targetVelocity.distTo(other->second.targetVelocity);
+            double direction_diff = order.targetDirection.distTo(other->second.targetDirection);
+            max_velocity_diff = std::max(max_velocity_diff, velocity_diff);
+            max_direction_diff = std::max(max_direction_diff, direction_diff);
+            bool same_action = actionString(order.action) == actionString(other->second.action);
+            if (velocity_diff > ORDER_TOLERANCE || direction_diff > ORDER_TOLERANCE || !same_action) {
+                ++diverged_orders;
+                diverged = true;
+            }
+        }
+        ++ticks;
+        if (diverged) {
+            ++diverged_ticks;
+            if (first_tick < 0) {
+                first_tick = tick;
+            }
+        }
+    }
+
+    void print(std::ostream& out) const {
+        out << "Precision divergence: " << diverged_orders << " of " << unit_orders << " unit orders in "
+            << diverged_ticks << " of " << ticks << " ticks";
+        if (first_tick >= 0) {
+            out << ", first at tick " << first_tick;
+        }
+        out << std::endl;
+        out << "Max order difference: velocity " << max_velocity_diff << ", direction " << max_direction_diff << std::endl;
+        out << "Planning time: double " << reference_ms << " ms, float " << candidate_ms << " ms" << std::endl;
+    }
+};
+
+}
+
+// Plays a game recorded with `ai_cup_22 --record <file>` through MyStrategy without a server.
+// With --compare-precision every tick is planned twice, in double and in float precision,
+// the double orders are played and the float ones are compared against them. Deadlines
+// are off in that mode, so a divergence never comes from rollouts a deadline skipped.
+// Usage: replay <file> [--orders <file>] [--compare-precision] [strategy options]
+int main(int argc, char *argv[])
+{
+    StrategyOptions options;
+    std::string replayPath;
+    std::string ordersPath;
+    bool comparePrecision = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (options.parse(argc, argv, i)) {
+            continue;
+        } else if (arg == "--orders" && i + 1 < argc) {
+            ordersPath = argv[++i];
+        } else if (arg == "--compare-precision") {
+            comparePrecision = true;
+        } else {
+            replayPath = arg;
+        }
+    }
+    if (replayPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <replay file> [--orders <file>] [--compare-precision] [strategy options]" << std::endl;
+        return 1;
+    }
+    if (comparePrecision) {
+        options.float_precision = false;
+        options.tick_budget_ms = 0;
+    }
+    StrategyOptions floatOptions = options;
+    floatOptions.float_precision = true;
+
+    ReplayStream stream(replayPath);
+    std::ofstream orders;
+    if (!ordersPath.empty()) {
+        orders.open(ordersPath);
+    }
+
+    std::unique_ptr<MyStrategy> myStrategy;
+    std::unique_ptr<MyStrategy> floatStrategy;
+    Divergence divergence;
+    int ticks = 0;
+    auto t_start = std::chrono::steady_clock::now();
+    codegame::ServerMessage message = codegame::Finish();
+    while (!stream.atEnd()) {
+        codegame::readServerMessage(stream, message);
+        if (const codegame::UpdateConstants *updateConstantsMessage = std::get_if<codegame::UpdateConstants>(&message)) {
+            myStrategy.reset(new MyStrategy(updateConstantsMessage->constants, options));
+            if (comparePrecision) {
+                floatStrategy.reset(new MyStrategy(updateConstantsMessage->constants, floatOptions));
+            }
+        } else if (codegame::GetOrder *getOrderMessage = std::get_if<codegame::GetOrder>(&message)) {
+            // getOrder changes the view it is given, so the float strategy gets a copy of it
+            std::optional<model::Game> floatView;
+            if (floatStrategy) {
+                floatView = getOrderMessage->playerView;
+            }
+            auto t_order = std::chrono::steady_clock::now();
+            auto order = myStrategy->getOrder(getOrderMessage->playerView, nullptr);
+            if (floatStrategy) {
+                auto t_float = std::chrono::steady_clock::now();
+                auto floatOrder = floatStrategy->getOrder(*floatView, nullptr);
+                auto t_done = std::chrono::steady_clock::now();
+                divergence.reference_ms += std::chrono::duration<double, std::milli>(t_float - t_order).count();
+                divergence.candidate_ms += std::chrono::duration<double, std::milli>(t_done - t_float).count();
+                divergence.compare(getOrderMessage->playerView.currentTick, order, floatOrder);
+            }
+            if (orders.is_open()) {
+                orders << getOrderMessage->playerView.currentTick << " " << order.toString() << "\n";
+            }
+            Profiler::Scope serialization(*myStrategy->profiler, Profiler::SERIALIZATION);
+            codegame::writeClientMessage(codegame::OrderMessage(order), stream);
+            stream.flush();
+            ++ticks;
+        } else if (std::get_if<codegame::Finish>(&message)) {
+            myStrategy->finish();
+            if (floatStrategy) {
+                divergence.print(std::cout);
+            }
+            break;
+        }
+        // Debug updates need a live viewer and are skipped
+    }
+    auto t_end = std::chrono::steady_clock::now();
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+    std::cout << "Replayed " << ticks << " ticks in " << elapsed_ms << " ms";
+    if (ticks > 0) {
+        std::cout << " (" << elapsed_ms / ticks << " ms per tick)";
+    }
+    std::cout << std::endl;
+    return 0;
+}